@@ -0,0 +1,231 @@
+#include "codec_bench.h"
+
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <png.h>
+
+#include "../errors/errors.h"
+#include "../graphics/capture_stream.h"
+#include "../graphics/video_encoder.h"
+#include "../graphics/png_encoder.h"
+#include "../graphics/replay_frame_source.h"
+#include "../graphics/synthetic_frame_source.h"
+
+namespace codec_bench = hotk::bench::codec_bench;
+
+using hotk::errors::ErrorCode;
+using hotk::graphics::frame::Frame;
+using hotk::graphics::capture_stream::CaptureStreamDecoder;
+using hotk::graphics::capture_stream::CaptureStreamEncoder;
+using hotk::graphics::video_encoder::VideoEncoder;
+using hotk::graphics::png_encoder::PngOptions;
+using hotk::graphics::png_encoder::encode_png;
+using hotk::graphics::png_encoder::encode_png_libpng;
+using hotk::graphics::frame_source::FrameSource;
+using hotk::graphics::replay_frame_source::ReplayFrameSource;
+using hotk::graphics::synthetic_frame_source::SyntheticFrameSource;
+
+namespace {
+	const char* next_argument(int& i, int argc, char* argv[])
+	{
+		if (i + 1 >= argc) {
+			std::string message = std::string("codec bench: missing value for ") + argv[i];
+			throw ErrorCode(1, message);
+		}
+
+		return argv[++i];
+	}
+
+	template <typename Encode>
+	std::vector<std::byte> timed(Encode encode, codec_bench::EncoderResult& result)
+	{
+		auto start  = std::chrono::steady_clock::now();
+		auto output = encode();
+		auto end    = std::chrono::steady_clock::now();
+
+		result.total_ms    += std::chrono::duration<double, std::milli>(end - start).count();
+		result.total_bytes += output.size();
+
+		return output;
+	}
+
+	// Decodes with libpng and compares the colour channels, GDI leaves
+	// alpha undefined so it is not part of the image.
+	bool decodes_to(const std::vector<std::byte>& png, const Frame& frame)
+	{
+		png_image image;
+
+		std::memset(&image, 0, sizeof(image));
+		image.version = PNG_IMAGE_VERSION;
+
+		if (!png_image_begin_read_from_memory(&image, png.data(), png.size()))
+			return false;
+
+		image.format = PNG_FORMAT_BGRA;
+
+		if (static_cast<int32_t>(image.width) != frame.width() || static_cast<int32_t>(image.height) != frame.height()) {
+			png_image_free(&image);
+			return false;
+		}
+
+		std::vector<std::byte> pixels(PNG_IMAGE_SIZE(image));
+
+		if (!png_image_finish_read(&image, nullptr, pixels.data(), 0, nullptr))
+			return false;
+
+		const std::size_t row_size = static_cast<std::size_t>(frame.width()) * 4;
+
+		for (int32_t y = 0; y < frame.height(); y++) {
+			const std::byte* expected = frame.row(y);
+			const std::byte* actual   = pixels.data() + row_size * y;
+
+			for (std::size_t x = 0; x < row_size; x += 4) {
+				if (std::memcmp(expected + x, actual + x, 3) != 0)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool stream_decodes_to(CaptureStreamDecoder& decoder, const std::vector<std::byte>& message, const Frame& frame)
+	{
+		if (!decoder.decode(message) || decoder.width() != frame.width() || decoder.height() != frame.height())
+			return false;
+
+		const auto* actual = decoder.pixels().data();
+
+		for (int32_t y = 0; y < frame.height(); y++) {
+			const std::byte* expected = frame.row(y);
+
+			for (int32_t x = 0; x < frame.width(); x++) {
+				if (std::memcmp(expected + x * 4, actual, 3) != 0)
+					return false;
+
+				actual += 3;
+			}
+		}
+
+		return true;
+	}
+}
+
+codec_bench::CodecBenchOptions codec_bench::parse_options(int argc, char* argv[])
+{
+	CodecBenchOptions options;
+
+	try {
+		for (int i = 0; i < argc; i++) {
+			const char* arg = argv[i];
+
+			if (strcmp(arg, "--frames") == 0)
+				options.frames = std::stoul(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--level") == 0)
+				options.compression_level = std::stoi(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--palette") == 0)
+				options.detect_palette = true;
+			else if (strcmp(arg, "--corpus") == 0)
+				options.corpus = next_argument(i, argc, argv);
+			else if (strcmp(arg, "--frame") == 0) {
+				std::string size = next_argument(i, argc, argv);
+				auto        x    = size.find('x');
+
+				if (x == std::string::npos)
+					throw ErrorCode(1, "codec bench: --frame expects WIDTHxHEIGHT");
+
+				options.frame_width  = std::stoi(size.substr(0, x));
+				options.frame_height = std::stoi(size.substr(x + 1));
+			}
+			else {
+				std::string message = std::string("codec bench: unknown option ") + arg;
+				throw ErrorCode(1, message);
+			}
+		}
+	}
+	catch (const std::logic_error&) {
+		throw ErrorCode(1, "codec bench: invalid numeric argument");
+	}
+
+	if (options.frames == 0 || options.frame_width <= 0 || options.frame_height <= 0)
+		throw ErrorCode(1, "codec bench: frames and frame size must be positive");
+
+	if (options.compression_level < 1 || options.compression_level > 12)
+		throw ErrorCode(1, "codec bench: --level must be between 1 and 12");
+
+	return options;
+}
+
+codec_bench::CodecBenchReport codec_bench::run(const CodecBenchOptions& options)
+{
+	std::unique_ptr<FrameSource> source;
+	CodecBenchReport             report;
+	PngOptions                   png_options;
+
+	if (options.corpus.empty())
+		source = std::make_unique<SyntheticFrameSource>(options.frame_width, options.frame_height);
+	else
+		source = std::make_unique<ReplayFrameSource>(options.corpus);
+
+	png_options.detect_palette    = options.detect_palette;
+	png_options.compression_level = options.compression_level;
+
+	CaptureStreamEncoder stream_encoder;
+	CaptureStreamDecoder stream_decoder;
+	VideoEncoder         video_encoder;
+
+	// The libpng encoder logs every row it writes.
+	auto* cout_buffer = std::cout.rdbuf(nullptr);
+
+	for (unsigned int i = 0; i < options.frames; i++) {
+		Frame frame = source->next_frame();
+
+		timed([&]() { return encode_png_libpng(frame, png_options); }, report.libpng);
+		auto png = timed([&]() { return encode_png(frame, png_options); }, report.native);
+
+		auto message = timed([&]() { return stream_encoder.encode(frame); }, report.stream);
+
+		timed([&]() { return video_encoder.encode(frame); }, report.video);
+
+		if (!decodes_to(png, frame) || !stream_decodes_to(stream_decoder, message, frame))
+			report.mismatches++;
+
+		report.frames++;
+	}
+
+	std::cout.rdbuf(cout_buffer);
+	std::cout.clear();
+
+	return report;
+}
+
+void codec_bench::print_report(std::ostream& out, const CodecBenchOptions& options, const CodecBenchReport& report)
+{
+	const double frames = report.frames > 0 ? report.frames : 1;
+
+	auto print = [&](const char* name, const EncoderResult& result) {
+		out << std::setw(16) << name << ": "
+			<< result.total_ms / frames << " ms/frame, "
+			<< result.total_bytes / frames / 1024 << " KiB/frame\n";
+	};
+
+	out << std::fixed << std::setprecision(2)
+		<< "Codec bench results:\n";
+
+	if (options.corpus.empty())
+		out << "           frame: " << options.frame_width << "x" << options.frame_height << "\n";
+	else
+		out << "          corpus: " << options.corpus << "\n";
+
+	out << "          frames: " << report.frames << "\n";
+	print("libpng", report.libpng);
+	print("native", report.native);
+	print("stream", report.stream);
+	print("video", report.video);
+	out << "      mismatches: " << report.mismatches << "\n";
+}
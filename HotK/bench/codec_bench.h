@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace hotk::bench::codec_bench {
+	struct CodecBenchOptions {
+		unsigned int frames            = 30;
+		int32_t      frame_width       = 1920;
+		int32_t      frame_height      = 1080;
+		int          compression_level = 6;
+		bool         detect_palette    = false;
+		// Frame corpus to replay instead of synthetic frames, see
+		// frame_corpus.h. The frame size then comes from the recording.
+		std::string  corpus;
+	};
+
+	struct EncoderResult {
+		double   total_ms    = 0;
+		uint64_t total_bytes = 0;
+	};
+
+	struct CodecBenchReport {
+		unsigned int  frames     = 0;
+		EncoderResult libpng;
+		EncoderResult native;
+		// Consecutive frames through a CaptureStreamEncoder.
+		EncoderResult stream;
+		// The same through a VideoEncoder at its default rate, I420
+		// conversion included. Lossy, so not checked.
+		EncoderResult video;
+		// Frames whose native PNG or stream message did not decode back to
+		// the source pixels.
+		unsigned int  mismatches = 0;
+	};
+
+	// Parses the arguments following --codec-bench:
+	//   --frames N  --frame WxH  --level L  --palette  --corpus PATH
+	CodecBenchOptions parse_options(int argc, char* argv[]);
+
+	// Encodes synthetic or recorded frames with the libpng and the native
+	// PNG encoder, as a capture stream and as video, and decodes every
+	// native PNG and stream message to check it.
+	CodecBenchReport run(const CodecBenchOptions&);
+
+	void print_report(std::ostream&, const CodecBenchOptions&, const CodecBenchReport&);
+}
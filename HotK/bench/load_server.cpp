@@ -0,0 +1,374 @@
+#include "load_server.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+
+#include "../net/messages/hello.h"
+
+using namespace hotk::bench::load_server;
+
+using hotk::net::messages::Hello;
+using hotk::net::messages::ImageCodec;
+using hotk::net::messages::header_size;
+using hotk::net::messages::encode_header;
+using hotk::net::messages::decode_header;
+using hotk::net::messages::serialize_hello;
+using hotk::net::messages::parse_hello;
+using hotk::net::messages::negotiate;
+
+namespace hello_features = hotk::net::messages::hello_features;
+
+using boost::asio::buffer;
+using boost::system::error_code;
+
+class LoadServer::Session : public std::enable_shared_from_this<LoadServer::Session> {
+private:
+	using Header = std::array<std::byte, hotk::net::messages::max_header_size>;
+
+	struct InFlightRequest {
+		MessageType       type;
+		clock::time_point sent_at;
+	};
+
+	tcp::socket                 _socket;
+	boost::asio::steady_timer   _timer;
+	const LoadServerOptions&    _options;
+	clock::time_point           _next_tick;
+	double                      _capture_credit;
+
+	std::deque<InFlightRequest> _in_flight;
+	std::vector<char>           _write_buffer;
+	std::vector<char>           _pending_writes;
+	bool                        _writing;
+	bool                        _closed;
+
+	HeaderFormat                _header_format;
+	bool                        _greeted;
+	Header                      _header;
+	uint64_t                    _packet_size;
+	MessageType                 _message_type;
+	std::vector<char>           _read_buffer;
+
+	Hello local_hello() const
+	{
+		Hello hello;
+
+		hello.version                 = hotk::net::messages::protocol_version;
+		hello.header_formats         |= 1 << static_cast<uint8_t>(_options.header_format);
+		hello.preferred_header_format = _options.header_format;
+		hello.codecs                  = 1 << static_cast<uint8_t>(ImageCodec::Png)
+			| 1 << static_cast<uint8_t>(ImageCodec::Jpeg);
+		hello.features                = hello_features::pipelining | hello_features::tile_delta
+			| hello_features::dropped_replies | hello_features::capture_stream | hello_features::monitors
+			| hello_features::video;
+
+		return hello;
+	}
+
+	// Replies with our Hello, still in the legacy header, then switches
+	// both directions to the negotiated format and starts the requests.
+	void greet()
+	{
+		auto hello      = local_hello();
+		auto negotiated = negotiate(hello, parse_hello(
+			std::vector<std::byte>(reinterpret_cast<const std::byte*>(_read_buffer.data()),
+				reinterpret_cast<const std::byte*>(_read_buffer.data()) + _read_buffer.size())));
+
+		queue_message(MessageType::Hello, serialize_hello(hello));
+
+		_greeted       = true;
+		_header_format = negotiated.preferred_header_format;
+
+		start_requests();
+	}
+
+	void queue_message(MessageType msg_type, const std::vector<std::byte>& payload)
+	{
+		Header      header;
+		std::size_t size = header_size(_header_format);
+
+		encode_header(_header_format, payload.size(), msg_type, header.data());
+
+		_pending_writes.insert(_pending_writes.end(),
+			reinterpret_cast<const char*>(header.data()), reinterpret_cast<const char*>(header.data()) + size);
+		_pending_writes.insert(_pending_writes.end(),
+			reinterpret_cast<const char*>(payload.data()), reinterpret_cast<const char*>(payload.data()) + payload.size());
+
+		flush_writes();
+	}
+
+	void start_requests()
+	{
+		if (_options.requests_per_second <= 0) {
+			for (unsigned int i = 0; i < std::max(1u, _options.max_in_flight); i++)
+				issue_request();
+
+			return;
+		}
+
+		_next_tick = clock::now();
+		schedule_tick();
+	}
+
+	void schedule_tick()
+	{
+		_next_tick += std::chrono::duration_cast<clock::duration>(
+			std::chrono::duration<double>(1.0 / _options.requests_per_second));
+		_timer.expires_at(_next_tick);
+
+		_timer.async_wait([self = shared_from_this()](const error_code err) {
+			if (err || self->_closed)
+				return;
+
+			if (self->_in_flight.size() < self->_options.max_in_flight)
+				self->issue_request();
+			else
+				self->skipped_requests++;
+
+			self->schedule_tick();
+		});
+	}
+
+	void issue_request()
+	{
+		auto msg_type = MessageType::MachineInfo;
+
+		_capture_credit += _options.screen_capture_ratio;
+		if (_capture_credit >= 1.0) {
+			_capture_credit -= 1.0;
+			msg_type = _options.capture_type;
+		}
+
+		// Only capture requests carry data, MachineInfo is just the header.
+		const auto& payload = msg_type == MessageType::MachineInfo
+			? std::vector<std::byte>()
+			: _options.capture_payload;
+
+		_in_flight.push_back({ msg_type, clock::now() });
+		requests_sent++;
+
+		queue_message(msg_type, payload);
+	}
+
+	void flush_writes()
+	{
+		if (_writing || _pending_writes.empty())
+			return;
+
+		_writing = true;
+		_write_buffer.swap(_pending_writes);
+		_pending_writes.clear();
+
+		boost::asio::async_write(_socket, buffer(_write_buffer),
+			[self = shared_from_this()](const error_code err, const size_t) {
+				self->_writing = false;
+
+				if (err)
+					return;
+
+				self->flush_writes();
+			}
+		);
+	}
+
+	void read_header()
+	{
+		boost::asio::async_read(_socket, buffer(_header.data(), header_size(_header_format)),
+			[self = shared_from_this()](const error_code err, const size_t) {
+				if (err)
+					return;
+
+				decode_header(self->_header_format, self->_header.data(), self->_packet_size, self->_message_type);
+
+				if (self->_packet_size == 0) {
+					self->_read_buffer.clear();
+					self->on_reply();
+					return;
+				}
+
+				self->read_data();
+			}
+		);
+	}
+
+	void read_data()
+	{
+		_read_buffer.resize(_packet_size);
+
+		boost::asio::async_read(_socket, buffer(_read_buffer),
+			[self = shared_from_this()](const error_code err, const size_t) {
+				if (err)
+					return;
+
+				self->on_reply();
+			}
+		);
+	}
+
+	void on_reply()
+	{
+		bytes_received += header_size(_header_format) + _packet_size;
+
+		if (_message_type == MessageType::Hello && _options.hello && !_greeted) {
+			greet();
+			read_header();
+			return;
+		}
+
+		// Replies come back in request order since the client handles one
+		// request at a time. Anything else is unsolicited and not timed.
+		// Progressive captures are answered by their preview, the final
+		// image follows later on its own.
+		auto reply_to = _message_type == MessageType::ScreenCapturePreview
+			|| _message_type == MessageType::ScreenCaptureMonitors
+			? MessageType::ScreenCapture
+			: _message_type;
+
+		if (!_in_flight.empty() && _in_flight.front().type == reply_to) {
+			auto latency = clock::now() - _in_flight.front().sent_at;
+
+			latencies_us.push_back(
+				std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+			_in_flight.pop_front();
+			replies_received++;
+
+			if (_options.requests_per_second <= 0)
+				issue_request();
+		}
+
+		read_header();
+	}
+
+public:
+	uint64_t              requests_sent;
+	uint64_t              replies_received;
+	uint64_t              bytes_received;
+	uint64_t              skipped_requests;
+	std::vector<uint64_t> latencies_us;
+
+	Session(boost::asio::io_context& io_service, tcp::socket&& socket, const LoadServerOptions& options)
+		: _socket(std::move(socket))
+		, _timer(io_service)
+		, _options(options)
+		, _capture_credit(0)
+		, _writing(false)
+		, _closed(false)
+		, _header_format(HeaderFormat::Legacy)
+		, _greeted(false)
+		, _packet_size(0)
+		, _message_type(MessageType::None)
+		, requests_sent(0)
+		, replies_received(0)
+		, bytes_received(0)
+		, skipped_requests(0)
+	{
+	}
+
+	void start()
+	{
+		read_header();
+
+		// Requests wait for the client's Hello.
+		if (!_options.hello)
+			start_requests();
+	}
+
+	void close()
+	{
+		error_code ignored;
+
+		_closed = true;
+		_timer.cancel();
+		_socket.close(ignored);
+	}
+};
+
+uint64_t LoadReport::percentile_us(double p) const
+{
+	if (latencies_us.empty())
+		return 0;
+
+	auto rank  = static_cast<std::size_t>(std::ceil(p * latencies_us.size()));
+	auto index = std::min(latencies_us.size() - 1, rank == 0 ? 0 : rank - 1);
+
+	return latencies_us[index];
+}
+
+LoadServer::LoadServer(const LoadServerOptions& options)
+	: _options(options)
+	, _acceptor(_io_service)
+{
+}
+
+LoadServer::~LoadServer()
+{
+	if (_thread.joinable())
+		stop();
+}
+
+void LoadServer::start()
+{
+	tcp::endpoint endpoint(boost::asio::ip::address_v4::loopback(), _options.port);
+
+	_acceptor.open(endpoint.protocol());
+	_acceptor.set_option(tcp::acceptor::reuse_address(true));
+	_acceptor.bind(endpoint);
+	_acceptor.listen();
+
+	accept();
+
+	_started_at = clock::now();
+	_thread     = std::thread([this]() { _io_service.run(); });
+}
+
+void LoadServer::accept()
+{
+	_acceptor.async_accept([this](const error_code err, tcp::socket socket) {
+		if (err)
+			return;
+
+		socket.set_option(tcp::no_delay(true));
+
+		auto session = std::make_shared<Session>(_io_service, std::move(socket), _options);
+		_sessions.push_back(session);
+		session->start();
+
+		accept();
+	});
+}
+
+LoadReport LoadServer::stop()
+{
+	LoadReport report;
+
+	boost::asio::post(_io_service, [this]() {
+		error_code ignored;
+
+		_acceptor.close(ignored);
+		for (auto& session : _sessions)
+			session->close();
+	});
+
+	report.elapsed_seconds = std::chrono::duration<double>(clock::now() - _started_at).count();
+
+	// Once every socket and timer is closed the io thread runs out of
+	// work and returns by itself.
+	_thread.join();
+
+	report.connections = static_cast<unsigned int>(_sessions.size());
+	for (auto& session : _sessions) {
+		report.requests_sent    += session->requests_sent;
+		report.replies_received += session->replies_received;
+		report.bytes_received   += session->bytes_received;
+		report.skipped_requests += session->skipped_requests;
+		report.latencies_us.insert(report.latencies_us.end(),
+			session->latencies_us.begin(), session->latencies_us.end());
+	}
+
+	_sessions.clear();
+	std::sort(report.latencies_us.begin(), report.latencies_us.end());
+
+	return report;
+}
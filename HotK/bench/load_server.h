@@ -0,0 +1,87 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../net/messages/message_type.h"
+#include "../net/messages/header_format.h"
+
+namespace hotk::bench::load_server {
+	using MessageType  = hotk::net::messages::MessageType;
+	using HeaderFormat = hotk::net::messages::HeaderFormat;
+
+	struct LoadServerOptions {
+		unsigned short port                 = 8080;
+
+		// Requests issued per second on every connection. A rate of zero
+		// runs closed loop: a new request goes out as soon as a reply
+		// frees an in-flight slot.
+		double         requests_per_second  = 10.0;
+		unsigned int   max_in_flight        = 1;
+
+		// Share of requests that are captures, the rest are MachineInfo.
+		double         screen_capture_ratio = 0.5;
+		MessageType    capture_type         = MessageType::ScreenCapture;
+
+		// Sent as the data of every capture request, see CaptureOptions.
+		std::vector<std::byte> capture_payload;
+
+		// Answer the client's Hello and wait for it before sending any
+		// request. Without it the server behaves like one from before the
+		// handshake and ignores the Hello.
+		bool           hello                = true;
+		HeaderFormat   header_format        = HeaderFormat::Compact;
+	};
+
+	struct LoadReport {
+		double                elapsed_seconds  = 0;
+		unsigned int          connections      = 0;
+		uint64_t              requests_sent    = 0;
+		uint64_t              replies_received = 0;
+		uint64_t              bytes_received   = 0;
+		uint64_t              skipped_requests = 0;
+
+		// Client side, summed over every connection when pacing is on.
+		uint64_t              paced_messages   = 0;
+		uint64_t              pacing_waits     = 0;
+		double                pacing_rate      = 0;
+
+		// Request to reply latencies in microseconds, sorted ascending.
+		std::vector<uint64_t> latencies_us;
+
+		uint64_t percentile_us(double) const;
+	};
+
+	// Stand-in for the real server: accepts any number of clients on
+	// 127.0.0.1 and keeps them busy with MachineInfo and ScreenCapture
+	// requests while timing every reply.
+	class LoadServer {
+	private:
+		using tcp = boost::asio::ip::tcp;
+		using clock = std::chrono::steady_clock;
+
+		class Session;
+
+		LoadServerOptions                      _options;
+		boost::asio::io_context                _io_service;
+		tcp::acceptor                          _acceptor;
+		std::thread                            _thread;
+		std::vector< std::shared_ptr<Session> > _sessions;
+		clock::time_point                      _started_at;
+
+		void accept();
+
+	public:
+		LoadServer(const LoadServerOptions&);
+		~LoadServer();
+
+		void start();
+		LoadReport stop();
+	};
+}
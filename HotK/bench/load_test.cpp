@@ -0,0 +1,274 @@
+#include "load_test.h"
+
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../errors/errors.h"
+#include "../graphics/replay_frame_source.h"
+#include "../graphics/synthetic_frame_source.h"
+#include "../handlers/handlers.h"
+#include "../handlers/workers.h"
+#include "../net/tcp_client.h"
+#include "../net/messages/capture_options.h"
+
+namespace load_test = hotk::bench::load_test;
+
+using hotk::bench::load_server::LoadServer;
+using hotk::errors::ErrorCode;
+using hotk::graphics::replay_frame_source::ReplayFrameSource;
+using hotk::graphics::synthetic_frame_source::SyntheticFrameSource;
+using hotk::net::TcpClient;
+using hotk::net::messages::MessageType;
+using hotk::net::messages::ImageCodec;
+using hotk::net::messages::HeaderFormat;
+
+using boost::system::error_code;
+
+namespace {
+	void on_connect(TcpClient& tcp_client, const error_code err)
+	{
+		if (err)
+			return;
+
+		hotk::handlers::reset_session(tcp_client);
+		hotk::handlers::send_hello(tcp_client);
+		tcp_client.read();
+	}
+
+	void on_read(TcpClient& tcp_client, const error_code err, const MessageType msg_type, std::vector<std::byte>&& data)
+	{
+		// The server closes every connection when the run is over.
+		if (err)
+			return;
+
+		tcp_client.read();
+
+		try {
+			hotk::handlers::process_message(tcp_client, msg_type, std::move(data));
+		}
+		catch (const std::exception&) {
+			// Failed requests simply never get a reply and show up as
+			// missing in the report.
+		}
+	}
+
+	void on_write(TcpClient&, const error_code, const size_t)
+	{
+	}
+
+	const char* next_argument(int& i, int argc, char* argv[])
+	{
+		if (i + 1 >= argc) {
+			std::string message = std::string("load test: missing value for ") + argv[i];
+			throw ErrorCode(1, message);
+		}
+
+		return argv[++i];
+	}
+}
+
+load_test::LoadTestOptions load_test::parse_options(int argc, char* argv[])
+{
+	LoadTestOptions options;
+	uint8_t         flags   = 0;
+	uint8_t         monitor = 0;
+
+	try {
+		for (int i = 0; i < argc; i++) {
+			const char* arg = argv[i];
+
+			if (strcmp(arg, "--clients") == 0)
+				options.clients = std::stoul(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--rate") == 0)
+				options.server.requests_per_second = std::stod(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--in-flight") == 0)
+				options.server.max_in_flight = std::stoul(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--capture-ratio") == 0)
+				options.server.screen_capture_ratio = std::stod(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--duration") == 0)
+				options.duration_seconds = std::stoul(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--port") == 0)
+				options.server.port = static_cast<unsigned short>(std::stoul(next_argument(i, argc, argv)));
+			else if (strcmp(arg, "--queue-budget") == 0)
+				options.queue_budget = std::stoull(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--latest-wins") == 0)
+				options.latest_wins = true;
+			else if (strcmp(arg, "--pace") == 0) {
+				options.pacing      = true;
+				options.pacing_rate = std::stoull(next_argument(i, argc, argv));
+			}
+			else if (strcmp(arg, "--freshness") == 0)
+				options.capture_freshness_ms = std::stoul(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--no-hello") == 0)
+				options.server.hello = false;
+			else if (strcmp(arg, "--legacy-header") == 0)
+				options.server.header_format = HeaderFormat::Legacy;
+			else if (strcmp(arg, "--tiles") == 0)
+				options.server.capture_type = MessageType::ScreenCaptureTiles;
+			else if (strcmp(arg, "--stream") == 0)
+				options.server.capture_type = MessageType::ScreenCaptureStream;
+			else if (strcmp(arg, "--video") == 0)
+				options.server.capture_type = MessageType::VideoFrame;
+			else if (strcmp(arg, "--jpeg") == 0) {
+				auto quality = static_cast<uint8_t>(std::stoul(next_argument(i, argc, argv)));
+
+				// See CaptureOptions: codec, quality, subsampling 4:2:0, flags.
+				options.server.capture_payload = {
+					static_cast<std::byte>(ImageCodec::Jpeg),
+					static_cast<std::byte>(quality),
+					static_cast<std::byte>(1),
+					static_cast<std::byte>(0),
+				};
+			}
+			else if (strcmp(arg, "--corpus") == 0)
+				options.corpus = next_argument(i, argc, argv);
+			else if (strcmp(arg, "--progressive") == 0)
+				flags |= hotk::net::messages::capture_flags::progressive;
+			else if (strcmp(arg, "--per-monitor") == 0)
+				flags |= hotk::net::messages::capture_flags::per_monitor;
+			else if (strcmp(arg, "--monitor") == 0)
+				monitor = static_cast<uint8_t>(std::stoul(next_argument(i, argc, argv)));
+			else if (strcmp(arg, "--monitors") == 0)
+				options.monitor_count = std::stoi(next_argument(i, argc, argv));
+			else if (strcmp(arg, "--frame") == 0) {
+				std::string size = next_argument(i, argc, argv);
+				auto        x    = size.find('x');
+
+				if (x == std::string::npos)
+					throw ErrorCode(1, "load test: --frame expects WIDTHxHEIGHT");
+
+				options.frame_width  = std::stoi(size.substr(0, x));
+				options.frame_height = std::stoi(size.substr(x + 1));
+			}
+			else {
+				std::string message = std::string("load test: unknown option ") + arg;
+				throw ErrorCode(1, message);
+			}
+		}
+	}
+	catch (const std::logic_error&) {
+		throw ErrorCode(1, "load test: invalid numeric argument");
+	}
+
+	// Sets the flags and monitor on top of whatever codec was chosen.
+	if (flags != 0 || monitor != 0) {
+		auto& payload = options.server.capture_payload;
+
+		if (payload.empty())
+			payload = { static_cast<std::byte>(ImageCodec::Png), static_cast<std::byte>(80), static_cast<std::byte>(1) };
+
+		payload.resize(5);
+		payload[3] |= static_cast<std::byte>(flags);
+		payload[4]  = static_cast<std::byte>(monitor);
+	}
+
+	if (options.clients == 0 || options.frame_width <= 0 || options.frame_height <= 0)
+		throw ErrorCode(1, "load test: clients and frame size must be positive");
+
+	if (options.monitor_count <= 0 || options.monitor_count > options.frame_width || monitor > options.monitor_count)
+		throw ErrorCode(1, "load test: invalid monitor count or monitor");
+
+	return options;
+}
+
+load_test::LoadReport load_test::run(const LoadTestOptions& options)
+{
+	auto port = std::to_string(options.server.port);
+
+	if (options.corpus.empty()) {
+		hotk::handlers::set_frame_source(
+			std::make_shared<SyntheticFrameSource>(options.frame_width, options.frame_height, options.monitor_count));
+	}
+	else {
+		hotk::handlers::set_frame_source(std::make_shared<ReplayFrameSource>(options.corpus));
+	}
+	hotk::handlers::set_capture_freshness(std::chrono::milliseconds(options.capture_freshness_ms));
+
+	LoadServer server(options.server);
+	server.start();
+
+	std::vector< std::unique_ptr<TcpClient> > clients;
+	std::vector<std::thread>                  threads;
+
+	for (unsigned int i = 0; i < options.clients; i++) {
+		auto client = std::make_unique<TcpClient>("127.0.0.1", port.c_str(), on_connect, on_read, on_write);
+
+		client->set_queue_budget(options.queue_budget);
+		if (options.latest_wins)
+			client->set_queue_policy(MessageType::ScreenCapture, TcpClient::QueuePolicy::LatestWins);
+		if (options.pacing) {
+			TcpClient::PacingOptions pacing;
+
+			pacing.rate = options.pacing_rate;
+			client->set_pacing(pacing);
+		}
+
+		clients.push_back(std::move(client));
+	}
+
+	// Handlers log every request, which would end up measuring the console
+	// instead of the client. Mute std::cout while the clients run.
+	auto* cout_buffer = std::cout.rdbuf(nullptr);
+
+	for (auto& client : clients) {
+		threads.emplace_back([tcp_client = client.get()]() {
+			tcp_client->connect();
+			tcp_client->run();
+		});
+	}
+
+	std::this_thread::sleep_for(std::chrono::seconds(options.duration_seconds));
+	auto report = server.stop();
+
+	for (auto& client : clients)
+		client->stop();
+
+	for (auto& thread : threads)
+		thread.join();
+
+	// Progressive encodes may still be about to write to the clients.
+	hotk::handlers::wait_for_workers();
+
+	for (auto& client : clients) {
+		auto stats = client->pacing_stats();
+
+		report.paced_messages += stats.paced_messages;
+		report.pacing_waits   += stats.waits;
+		report.pacing_rate    += stats.rate / clients.size();
+	}
+
+	std::cout.rdbuf(cout_buffer);
+	std::cout.clear();
+
+	return report;
+}
+
+void load_test::print_report(std::ostream& out, const LoadTestOptions& options, const LoadReport& report)
+{
+	const double elapsed = report.elapsed_seconds > 0 ? report.elapsed_seconds : 1;
+
+	out << std::fixed << std::setprecision(2)
+		<< "Load test results:\n"
+		<< "         clients: " << report.connections << "/" << options.clients << "\n"
+		<< "           frame: " << options.frame_width << "x" << options.frame_height
+			<< " on " << options.monitor_count << " monitor(s)\n"
+		<< "        duration: " << report.elapsed_seconds << " s\n"
+		<< "   requests sent: " << report.requests_sent << "\n"
+		<< "replies received: " << report.replies_received << "\n"
+		<< "         skipped: " << report.skipped_requests << " (in-flight limit reached)\n"
+		<< "      requests/s: " << report.replies_received / elapsed << "\n"
+		<< "         bytes/s: " << report.bytes_received / elapsed << "\n"
+		<< "     latency p50: " << report.percentile_us(0.50) / 1000.0 << " ms\n"
+		<< "     latency p99: " << report.percentile_us(0.99) / 1000.0 << " ms\n"
+		<< "    latency p999: " << report.percentile_us(0.999) / 1000.0 << " ms\n";
+
+	if (options.pacing) {
+		out << "  paced messages: " << report.paced_messages << ", " << report.pacing_waits << " waits\n"
+			<< "     pacing rate: " << report.pacing_rate << " bytes/s per client\n";
+	}
+}
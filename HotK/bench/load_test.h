@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "load_server.h"
+
+namespace hotk::bench::load_test {
+	using hotk::bench::load_server::LoadServerOptions;
+	using hotk::bench::load_server::LoadReport;
+
+	struct LoadTestOptions {
+		LoadServerOptions server;
+		unsigned int      clients          = 4;
+		unsigned int      duration_seconds = 10;
+		int32_t           frame_width      = 1920;
+		int32_t           frame_height     = 1080;
+		// Splits synthetic frames into this many side by side monitors.
+		int32_t           monitor_count    = 1;
+
+		// Client send queue settings, see TcpClient::set_queue_budget.
+		std::size_t       queue_budget     = 0;
+		bool              latest_wins      = false;
+
+		// See handlers::set_capture_freshness.
+		unsigned int      capture_freshness_ms = 50;
+
+		// Paces bulk writes at this many bytes per second, 0 estimates it.
+		bool              pacing           = false;
+		std::size_t       pacing_rate      = 0;
+
+		// Replays a frame corpus instead of synthetic frames.
+		std::string       corpus;
+	};
+
+	// Parses the arguments following --load-test:
+	//   --clients N  --rate R  --in-flight N  --capture-ratio X
+	//   --duration S --frame WxH --port P
+	//   --queue-budget BYTES --latest-wins --tiles --jpeg QUALITY
+	//   --no-hello --legacy-header --freshness MS --progressive
+	//   --corpus PATH --stream --monitors N --per-monitor --monitor N
+	//   --video --pace BYTES_PER_SECOND
+	LoadTestOptions parse_options(int argc, char* argv[]);
+
+	// Starts a LoadServer and the requested number of TcpClients in this
+	// process, all of them serving synthetic frames, and measures them for
+	// the configured duration.
+	LoadReport run(const LoadTestOptions&);
+
+	void print_report(std::ostream&, const LoadTestOptions&, const LoadReport&);
+}
@@ -1,5 +1,7 @@
 #include "errors.h"
 
+#include <cstring>
+
 using namespace hotk::errors;
 
 ErrorCode::ErrorCode() noexcept
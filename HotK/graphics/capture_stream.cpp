@@ -0,0 +1,229 @@
+#include "capture_stream.h"
+#include "../errors/errors.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include <zstd.h>
+
+namespace capture_stream = hotk::graphics::capture_stream;
+
+using capture_stream::CaptureStreamDecoder;
+using capture_stream::CaptureStreamEncoder;
+using capture_stream::StreamFrameKind;
+using hotk::errors::ErrorCode;
+using hotk::graphics::frame::Frame;
+
+namespace {
+	const std::size_t header_size    = 16;
+	const int         min_window_log = 10;
+	const int         max_window_log = 30;
+
+	void check(std::size_t result, const char* what)
+	{
+		if (ZSTD_isError(result)) {
+			std::string message = std::string("capture stream: ") + what + ": " + ZSTD_getErrorName(result);
+			throw ErrorCode(1, message);
+		}
+	}
+
+	// Smallest window that still reaches from the end of the frame back to
+	// the start of its prefix.
+	int window_log_for(std::size_t size)
+	{
+		int log = min_window_log;
+
+		while (log < max_window_log && (std::size_t(1) << log) < size)
+			log++;
+
+		return log;
+	}
+
+	void to_bgr(const Frame& frame, std::vector<uint8_t>& bgr)
+	{
+		bgr.resize(static_cast<std::size_t>(frame.width()) * frame.height() * 3);
+
+		auto* target = bgr.data();
+
+		for (int32_t y = 0; y < frame.height(); y++) {
+			const auto* source = reinterpret_cast<const uint8_t*>(frame.row(y));
+
+			for (int32_t x = 0; x < frame.width(); x++) {
+				target[0] = source[0];
+				target[1] = source[1];
+				target[2] = source[2];
+
+				target += 3;
+				source += 4;
+			}
+		}
+	}
+
+	template <typename T>
+	void put(std::byte* target, T value)
+	{
+		std::memcpy(target, &value, sizeof(T));
+	}
+
+	template <typename T>
+	T get(const std::byte* source)
+	{
+		T value;
+		std::memcpy(&value, source, sizeof(T));
+		return value;
+	}
+}
+
+void capture_stream::CompressorDeleter::operator()(ZSTD_CCtx* context)
+{
+	ZSTD_freeCCtx(context);
+}
+
+void capture_stream::DecompressorDeleter::operator()(ZSTD_DCtx* context)
+{
+	ZSTD_freeDCtx(context);
+}
+
+CaptureStreamEncoder::CaptureStreamEncoder(const StreamOptions& options)
+	: _options(options)
+	, _context(ZSTD_createCCtx())
+	, _width(0)
+	, _height(0)
+	, _sequence(0)
+	, _since_keyframe(0)
+	, _keyframe_requested(true)
+{
+	if (!_context)
+		throw ErrorCode(1, "capture stream: failed to create the zstd context");
+}
+
+void CaptureStreamEncoder::reset()
+{
+	_keyframe_requested = true;
+	_sequence           = 0;
+}
+
+std::vector<std::byte> CaptureStreamEncoder::encode(const Frame& frame)
+{
+	to_bgr(frame, _current);
+
+	bool keyframe = _keyframe_requested
+		|| _previous.empty()
+		|| frame.width() != _width
+		|| frame.height() != _height
+		|| _since_keyframe >= _options.keyframe_interval;
+
+	std::size_t reach      = _current.size() + (keyframe ? 0 : _previous.size());
+	int         window_log = window_log_for(reach);
+
+	check(ZSTD_CCtx_reset(_context.get(), ZSTD_reset_session_only), "reset");
+	check(ZSTD_CCtx_setParameter(_context.get(), ZSTD_c_compressionLevel, _options.compression_level), "level");
+	check(ZSTD_CCtx_setParameter(_context.get(), ZSTD_c_enableLongDistanceMatching, 1), "long distance matching");
+	check(ZSTD_CCtx_setParameter(_context.get(), ZSTD_c_windowLog, window_log), "window log");
+
+	// The prefix only applies to the next frame, it has to be set again
+	// every time.
+	if (!keyframe)
+		check(ZSTD_CCtx_refPrefix(_context.get(), _previous.data(), _previous.size()), "prefix");
+
+	std::vector<std::byte> output(header_size + ZSTD_compressBound(_current.size()));
+	std::size_t            size = ZSTD_compress2(_context.get(),
+		output.data() + header_size, output.size() - header_size, _current.data(), _current.size());
+
+	check(size, "compress");
+	output.resize(header_size + size);
+
+	if (keyframe) {
+		_since_keyframe     = 0;
+		_keyframe_requested = false;
+	}
+
+	put<uint32_t>(output.data(), _sequence);
+	output[4] = static_cast<std::byte>(keyframe ? StreamFrameKind::Key : StreamFrameKind::Delta);
+	output[5] = static_cast<std::byte>(window_log);
+	put<uint16_t>(output.data() + 6, 0);
+	put<int32_t>(output.data() + 8, frame.width());
+	put<int32_t>(output.data() + 12, frame.height());
+
+	_width  = frame.width();
+	_height = frame.height();
+	_sequence++;
+	_since_keyframe++;
+	_previous.swap(_current);
+
+	return output;
+}
+
+CaptureStreamDecoder::CaptureStreamDecoder()
+	: _context(ZSTD_createDCtx())
+	, _width(0)
+	, _height(0)
+	, _sequence(0)
+	, _has_frame(false)
+{
+	if (!_context)
+		throw ErrorCode(1, "capture stream: failed to create the zstd context");
+}
+
+bool CaptureStreamDecoder::decode(const std::vector<std::byte>& payload)
+{
+	if (payload.size() < header_size)
+		throw ErrorCode(1, "capture stream: message is too short");
+
+	auto sequence   = get<uint32_t>(payload.data());
+	auto kind       = static_cast<StreamFrameKind>(payload[4]);
+	auto window_log = static_cast<int>(payload[5]);
+	auto width      = get<int32_t>(payload.data() + 8);
+	auto height     = get<int32_t>(payload.data() + 12);
+	bool keyframe   = kind == StreamFrameKind::Key;
+
+	if (width <= 0 || height <= 0 || window_log > max_window_log)
+		throw ErrorCode(1, "capture stream: bad message header");
+
+	if (!keyframe && (!_has_frame || sequence != _sequence + 1 || width != _width || height != _height))
+		return false;
+
+	_current.resize(static_cast<std::size_t>(width) * height * 3);
+
+	check(ZSTD_DCtx_reset(_context.get(), ZSTD_reset_session_only), "reset");
+	check(ZSTD_DCtx_setParameter(_context.get(), ZSTD_d_windowLogMax, std::max(window_log, min_window_log)), "window log");
+
+	if (!keyframe)
+		check(ZSTD_DCtx_refPrefix(_context.get(), _previous.data(), _previous.size()), "prefix");
+
+	std::size_t size = ZSTD_decompressDCtx(_context.get(), _current.data(), _current.size(),
+		payload.data() + header_size, payload.size() - header_size);
+
+	check(size, "decompress");
+	if (size != _current.size())
+		throw ErrorCode(1, "capture stream: frame size does not match its header");
+
+	_previous.swap(_current);
+	_width     = width;
+	_height    = height;
+	_sequence  = sequence;
+	_has_frame = true;
+
+	return true;
+}
+
+int32_t CaptureStreamDecoder::width() const noexcept
+{
+	return _width;
+}
+
+int32_t CaptureStreamDecoder::height() const noexcept
+{
+	return _height;
+}
+
+uint32_t CaptureStreamDecoder::sequence() const noexcept
+{
+	return _sequence;
+}
+
+const std::vector<uint8_t>& CaptureStreamDecoder::pixels() const noexcept
+{
+	return _previous;
+}
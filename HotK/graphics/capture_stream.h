@@ -0,0 +1,94 @@
+#pragma once
+
+#include "frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace hotk::graphics::capture_stream {
+	using hotk::graphics::frame::Frame;
+
+	// Consecutive captures compressed as one stream: every delta frame is
+	// a zstd frame that uses the previous capture as its prefix, with long
+	// distance matching so unchanged rows become a few long matches.
+	// Integers are in host byte order like the message header:
+	//
+	//   uint32 sequence          0 on a keyframe after a reset, +1 per message
+	//   uint8  kind              StreamFrameKind
+	//   uint8  window_log        the decoder must accept windows this large
+	//   uint16 reserved
+	//   int32  width, height
+	//   zstd frame               BGR rows top to bottom, a delta references
+	//                            the decoded pixels of sequence - 1
+	//
+	// Keyframes are sent every keyframe_interval messages, whenever the
+	// frame size changes and when the server asks for a resync after
+	// losing a message.
+	enum class StreamFrameKind : uint8_t {
+		Key = 0,
+		Delta,
+	};
+
+	struct StreamOptions {
+		int      compression_level = 3;
+		uint32_t keyframe_interval = 300;
+	};
+
+	struct CompressorDeleter {
+		void operator()(ZSTD_CCtx_s*);
+	};
+
+	struct DecompressorDeleter {
+		void operator()(ZSTD_DCtx_s*);
+	};
+
+	class CaptureStreamEncoder {
+	private:
+		StreamOptions                                   _options;
+		std::unique_ptr<ZSTD_CCtx_s, CompressorDeleter> _context;
+		std::vector<uint8_t>                            _previous;
+		std::vector<uint8_t>                            _current;
+		int32_t                                         _width;
+		int32_t                                         _height;
+		uint32_t                                        _sequence;
+		uint32_t                                        _since_keyframe;
+		bool                                            _keyframe_requested;
+
+	public:
+		explicit CaptureStreamEncoder(const StreamOptions& = StreamOptions());
+
+		// The next message is a keyframe with sequence 0.
+		void reset();
+		std::vector<std::byte> encode(const Frame&);
+	};
+
+	// Server side counterpart, kept here so both ends stay in step.
+	class CaptureStreamDecoder {
+	private:
+		std::unique_ptr<ZSTD_DCtx_s, DecompressorDeleter> _context;
+		std::vector<uint8_t>                              _previous;
+		std::vector<uint8_t>                              _current;
+		int32_t                                           _width;
+		int32_t                                           _height;
+		uint32_t                                          _sequence;
+		bool                                              _has_frame;
+
+	public:
+		CaptureStreamDecoder();
+
+		// Returns false, keeping the last frame, when a delta does not
+		// follow the frame decoded last. Ask the encoder for a resync then.
+		bool decode(const std::vector<std::byte>& payload);
+
+		int32_t width() const noexcept;
+		int32_t height() const noexcept;
+		uint32_t sequence() const noexcept;
+		// BGR, rows top to bottom.
+		const std::vector<uint8_t>& pixels() const noexcept;
+	};
+}
@@ -0,0 +1,58 @@
+#include "downscale.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace downscale = hotk::graphics::downscale;
+
+using hotk::graphics::frame::Frame;
+
+Frame downscale::downscale(const Frame& frame, int32_t max_side)
+{
+	assert(max_side > 0);
+
+	const int32_t longest = std::max(frame.width(), frame.height());
+	const int32_t factor  = std::max(1, (longest + max_side - 1) / max_side);
+	const int32_t width   = (frame.width() + factor - 1) / factor;
+	const int32_t height  = (frame.height() + factor - 1) / factor;
+	const std::size_t stride = static_cast<std::size_t>(width) * 4;
+
+	std::vector<std::byte> pixels(stride * height);
+	std::vector<uint32_t>  sums(static_cast<std::size_t>(width) * 4);
+
+	for (int32_t y = 0; y < height; y++) {
+		const int32_t first_row = y * factor;
+		const int32_t rows      = std::min(factor, frame.height() - first_row);
+
+		std::fill(sums.begin(), sums.end(), 0);
+
+		// Sum whole rows first, that walks the source in memory order.
+		for (int32_t source_y = first_row; source_y < first_row + rows; source_y++) {
+			const auto* source = reinterpret_cast<const uint8_t*>(frame.row(source_y));
+
+			for (int32_t x = 0; x < frame.width(); x++) {
+				uint32_t* sum = sums.data() + static_cast<std::size_t>(x / factor) * 4;
+
+				sum[0] += source[0];
+				sum[1] += source[1];
+				sum[2] += source[2];
+				sum[3] += source[3];
+				source += 4;
+			}
+		}
+
+		// Frames are stored bottom-up.
+		auto* target = reinterpret_cast<uint8_t*>(pixels.data() + stride * (height - 1 - y));
+
+		for (int32_t x = 0; x < width; x++) {
+			const uint32_t columns = static_cast<uint32_t>(std::min(factor, frame.width() - x * factor));
+			const uint32_t count   = columns * static_cast<uint32_t>(rows);
+
+			for (int channel = 0; channel < 4; channel++)
+				target[x * 4 + channel] = static_cast<uint8_t>((sums[x * 4 + channel] + count / 2) / count);
+		}
+	}
+
+	return Frame(width, height, std::move(pixels));
+}
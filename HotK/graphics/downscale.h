@@ -0,0 +1,14 @@
+#pragma once
+
+#include "frame.h"
+
+#include <cstdint>
+
+namespace hotk::graphics::downscale {
+	using hotk::graphics::frame::Frame;
+
+	// Shrinks the frame by the smallest whole factor that brings its
+	// longer side down to max_side, averaging every factor x factor block.
+	// Frames that already fit come back as a copy.
+	Frame downscale(const Frame&, int32_t max_side);
+}
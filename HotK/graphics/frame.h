@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace hotk::graphics::frame {
+	// Raw 32 bit BGRA image. Rows are stored bottom-up, the same layout
+	// GetDIBits produces for a bitmap with a positive height, so captures
+	// can be handed over without any swizzling or flipping.
+	//
+	// Frames are immutable, copies share the pixels.
+	class Frame {
+	private:
+		int32_t                          _width;
+		int32_t                          _height;
+		std::shared_ptr<const std::byte> _pixels;
+		std::size_t                      _size;
+
+	public:
+		Frame(int32_t width, int32_t height, std::vector<std::byte>&& pixels)
+			: _width(width)
+			, _height(height)
+			, _size(pixels.size())
+		{
+			auto owner = std::make_shared<const std::vector<std::byte>>(std::move(pixels));
+
+			_pixels = std::shared_ptr<const std::byte>(owner, owner->data());
+		}
+
+		// Wraps pixels that live elsewhere, e.g. in a mapped file, without
+		// copying them. pixels keeps whatever owns them alive.
+		Frame(int32_t width, int32_t height, std::shared_ptr<const std::byte> pixels, std::size_t size) noexcept
+			: _width(width)
+			, _height(height)
+			, _pixels(std::move(pixels))
+			, _size(size)
+		{
+		}
+
+		int32_t width() const noexcept {
+			return _width;
+		}
+
+		int32_t height() const noexcept {
+			return _height;
+		}
+
+		std::size_t stride() const noexcept {
+			return static_cast<std::size_t>(_width) * 4;
+		}
+
+		const std::byte* data() const noexcept {
+			return _pixels.get();
+		}
+
+		std::size_t size() const noexcept {
+			return _size;
+		}
+
+		// Returns the y-th row counting from the top of the image.
+		const std::byte* row(int32_t y) const noexcept {
+			return data() + static_cast<std::size_t>(_height - 1 - y) * stride();
+		}
+	};
+}
@@ -0,0 +1,236 @@
+#include "frame_corpus.h"
+#include "../errors/errors.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+
+#include <array>
+#include <cstring>
+
+namespace frame_corpus = hotk::graphics::frame_corpus;
+
+using frame_corpus::CorpusEntry;
+using frame_corpus::CorpusReader;
+using frame_corpus::CorpusWriter;
+using frame_corpus::corpus_alignment;
+using hotk::errors::ErrorCode;
+using hotk::graphics::frame::Frame;
+
+namespace {
+	const char        file_magic[8]   = { 'H', 'O', 'T', 'K', 'C', 'O', 'R', 'P' };
+	const char        record_magic[4] = { 'F', 'R', 'M', 'E' };
+	const uint32_t    version         = 1;
+	const std::size_t header_size     = 64;
+	const std::size_t record_size     = 64;
+
+	std::size_t align(std::size_t offset)
+	{
+		return (offset + corpus_alignment - 1) & ~(corpus_alignment - 1);
+	}
+
+	template <typename T>
+	void put(std::byte* target, T value)
+	{
+		for (std::size_t i = 0; i < sizeof(T); i++)
+			target[i] = static_cast<std::byte>(static_cast<uint64_t>(value) >> (8 * i));
+	}
+
+	template <typename T>
+	T get(const std::byte* source)
+	{
+		uint64_t value = 0;
+
+		for (std::size_t i = 0; i < sizeof(T); i++)
+			value |= static_cast<uint64_t>(source[i]) << (8 * i);
+
+		return static_cast<T>(value);
+	}
+}
+
+CorpusWriter::CorpusWriter(const std::string& path)
+	: _file(path, std::ios::binary | std::ios::trunc)
+	, _offset(header_size)
+{
+	if (!_file) {
+		std::string message = "frame corpus: failed to create " + path;
+		throw ErrorCode(1, message);
+	}
+
+	std::array<std::byte, header_size> header = {};
+
+	std::memcpy(header.data(), file_magic, sizeof(file_magic));
+	put<uint32_t>(header.data() + 8, version);
+
+	_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+CorpusWriter::~CorpusWriter()
+{
+	try {
+		close();
+	}
+	catch (const std::exception&) {
+		// Readers fall back to scanning the records.
+	}
+}
+
+void CorpusWriter::append(const Frame& frame, uint64_t timestamp_us)
+{
+	if (!_file.is_open())
+		throw ErrorCode(1, "frame corpus: append after close");
+
+	const std::array<char, corpus_alignment> zeros   = {};
+	std::array<std::byte, record_size>       record  = {};
+	const std::size_t                        padding = align(frame.size()) - frame.size();
+
+	std::memcpy(record.data(), record_magic, sizeof(record_magic));
+	put<int32_t>(record.data() + 4, frame.width());
+	put<int32_t>(record.data() + 8, frame.height());
+	put<uint64_t>(record.data() + 16, timestamp_us);
+	put<uint64_t>(record.data() + 24, frame.size());
+
+	_file.write(reinterpret_cast<const char*>(record.data()), record.size());
+	_file.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+	_file.write(zeros.data(), padding);
+
+	if (!_file)
+		throw ErrorCode(1, "frame corpus: failed to write frame");
+
+	_index.push_back(_offset);
+	_offset += record_size + frame.size() + padding;
+}
+
+void CorpusWriter::close()
+{
+	if (!_file.is_open())
+		return;
+
+	std::vector<std::byte>                      index(_index.size() * sizeof(uint64_t));
+	std::array<std::byte, 2 * sizeof(uint64_t)> counts;
+
+	for (std::size_t i = 0; i < _index.size(); i++)
+		put<uint64_t>(index.data() + i * sizeof(uint64_t), _index[i]);
+
+	put<uint64_t>(counts.data(), _index.size());
+	put<uint64_t>(counts.data() + sizeof(uint64_t), _offset);
+
+	_file.write(reinterpret_cast<const char*>(index.data()), index.size());
+	_file.seekp(16);
+	_file.write(reinterpret_cast<const char*>(counts.data()), counts.size());
+	_file.close();
+
+	if (_file.fail())
+		throw ErrorCode(1, "frame corpus: failed to write the index");
+}
+
+CorpusReader::CorpusReader(const std::string& path)
+{
+	try {
+		boost::interprocess::file_mapping mapping(path.c_str(), boost::interprocess::read_only);
+
+		_region = std::make_shared<boost::interprocess::mapped_region>(mapping, boost::interprocess::read_only);
+	}
+	catch (const boost::interprocess::interprocess_exception& err) {
+		std::string message = "frame corpus: failed to map " + path + ": " + err.what();
+		throw ErrorCode(1, message);
+	}
+
+	const auto* data = static_cast<const std::byte*>(_region->get_address());
+
+	if (_region->get_size() < header_size || std::memcmp(data, file_magic, sizeof(file_magic)) != 0) {
+		std::string message = "frame corpus: " + path + " is not a frame corpus";
+		throw ErrorCode(1, message);
+	}
+
+	if (get<uint32_t>(data + 8) != version) {
+		std::string message = "frame corpus: unsupported version in " + path;
+		throw ErrorCode(1, message);
+	}
+
+	uint64_t frame_count  = get<uint64_t>(data + 16);
+	uint64_t index_offset = get<uint64_t>(data + 24);
+
+	const std::size_t size = _region->get_size();
+
+	// A truncated copy loses its index but keeps most of its records.
+	if (index_offset != 0 && index_offset <= size && frame_count <= (size - index_offset) / sizeof(uint64_t))
+		read_index(frame_count, index_offset);
+	else
+		scan_records();
+}
+
+void CorpusReader::read_index(uint64_t frame_count, uint64_t index_offset)
+{
+	const auto* data = static_cast<const std::byte*>(_region->get_address());
+
+	_entries.reserve(frame_count);
+
+	for (uint64_t i = 0; i < frame_count; i++) {
+		uint64_t offset = get<uint64_t>(data + index_offset + i * sizeof(uint64_t));
+
+		if (offset > index_offset || index_offset - offset < record_size
+				|| std::memcmp(data + offset, record_magic, sizeof(record_magic)) != 0) {
+			throw ErrorCode(1, "frame corpus: index points at a bad record");
+		}
+
+		CorpusEntry entry = {
+			get<int32_t>(data + offset + 4),
+			get<int32_t>(data + offset + 8),
+			get<uint64_t>(data + offset + 16),
+			static_cast<std::size_t>(offset + record_size),
+			static_cast<std::size_t>(get<uint64_t>(data + offset + 24)),
+		};
+
+		if (entry.size > index_offset - entry.offset
+				|| entry.size != static_cast<std::size_t>(entry.width) * entry.height * 4) {
+			throw ErrorCode(1, "frame corpus: record size does not match its frame");
+		}
+
+		_entries.push_back(entry);
+	}
+}
+
+void CorpusReader::scan_records()
+{
+	const auto*       data   = static_cast<const std::byte*>(_region->get_address());
+	const std::size_t size   = _region->get_size();
+	std::size_t       offset = header_size;
+
+	while (size - offset >= record_size && std::memcmp(data + offset, record_magic, sizeof(record_magic)) == 0) {
+		CorpusEntry entry = {
+			get<int32_t>(data + offset + 4),
+			get<int32_t>(data + offset + 8),
+			get<uint64_t>(data + offset + 16),
+			offset + record_size,
+			static_cast<std::size_t>(get<uint64_t>(data + offset + 24)),
+		};
+
+		// The recorder died while writing this one.
+		if (entry.size > size - entry.offset || entry.size != static_cast<std::size_t>(entry.width) * entry.height * 4)
+			break;
+
+		_entries.push_back(entry);
+		offset = entry.offset + align(entry.size);
+
+		if (offset > size)
+			break;
+	}
+}
+
+std::size_t CorpusReader::frame_count() const noexcept
+{
+	return _entries.size();
+}
+
+const CorpusEntry& CorpusReader::entry(std::size_t index) const
+{
+	return _entries.at(index);
+}
+
+Frame CorpusReader::frame(std::size_t index) const
+{
+	const auto& frame_entry = entry(index);
+	const auto* pixels      = static_cast<const std::byte*>(_region->get_address()) + frame_entry.offset;
+
+	return Frame(frame_entry.width, frame_entry.height,
+		std::shared_ptr<const std::byte>(_region, pixels), frame_entry.size);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "frame.h"
+
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hotk::graphics::frame_corpus {
+	using hotk::graphics::frame::Frame;
+
+	// File of raw frames recorded from a desktop, for replaying real
+	// workloads through the encoders. Little endian, every record starts
+	// on a 64 byte boundary so mapped pixels are aligned for SIMD:
+	//
+	//   header, 64 bytes
+	//     char[8] magic          "HOTKCORP"
+	//     uint32  version        1
+	//     uint32  reserved
+	//     uint64  frame_count    0 until the writer is closed
+	//     uint64  index_offset   0 until the writer is closed
+	//   frame_count x record
+	//     uint32  magic          "FRME"
+	//     int32   width, height
+	//     uint32  reserved
+	//     uint64  timestamp_us   since the recording started
+	//     uint64  size           pixel bytes, width * height * 4
+	//     padding to 64 bytes
+	//     pixels                 bottom-up BGRA exactly as Frame holds them
+	//     padding to 64 bytes
+	//   index                    frame_count x uint64 record offsets
+	//
+	// Recordings that were never closed, e.g. killed with Ctrl+C, have no
+	// index. The reader then walks the records instead and drops a
+	// truncated last one.
+	const std::size_t corpus_alignment = 64;
+
+	struct CorpusEntry {
+		int32_t     width;
+		int32_t     height;
+		uint64_t    timestamp_us;
+		std::size_t offset;
+		std::size_t size;
+	};
+
+	class CorpusWriter {
+	private:
+		std::ofstream         _file;
+		std::vector<uint64_t> _index;
+		uint64_t              _offset;
+
+	public:
+		explicit CorpusWriter(const std::string& path);
+		~CorpusWriter();
+
+		// Not thread-safe.
+		void append(const Frame&, uint64_t timestamp_us);
+		// Writes the index. Called by the destructor when needed.
+		void close();
+	};
+
+	class CorpusReader {
+	private:
+		std::shared_ptr<boost::interprocess::mapped_region> _region;
+		std::vector<CorpusEntry>                            _entries;
+
+		void read_index(uint64_t frame_count, uint64_t index_offset);
+		void scan_records();
+
+	public:
+		explicit CorpusReader(const std::string& path);
+
+		std::size_t frame_count() const noexcept;
+		const CorpusEntry& entry(std::size_t) const;
+
+		// Points straight into the mapping, which the frame keeps alive.
+		Frame frame(std::size_t) const;
+	};
+}
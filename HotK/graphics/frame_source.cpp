@@ -0,0 +1,54 @@
+#include "frame_source.h"
+#include "../errors/errors.h"
+
+#include <cstring>
+
+using namespace hotk::graphics::frame_source;
+
+using hotk::errors::ErrorCode;
+
+namespace {
+	Frame crop(const Frame& frame, const Monitor& monitor)
+	{
+		if (monitor.x < 0 || monitor.y < 0 || monitor.width <= 0 || monitor.height <= 0
+			|| monitor.x + monitor.width > frame.width() || monitor.y + monitor.height > frame.height())
+			throw ErrorCode(1, "frame source: monitor lies outside the frame");
+
+		// Monitors spanning the whole frame, i.e. single monitor setups,
+		// keep sharing its pixels.
+		if (monitor.width == frame.width() && monitor.height == frame.height())
+			return frame;
+
+		const std::size_t      stride = static_cast<std::size_t>(monitor.width) * 4;
+		std::vector<std::byte> pixels(stride * monitor.height);
+
+		// Both are stored bottom-up, row(y) counts from the top.
+		for (int32_t y = 0; y < monitor.height; y++) {
+			std::memcpy(
+				pixels.data() + static_cast<std::size_t>(monitor.height - 1 - y) * stride,
+				frame.row(monitor.y + y) + static_cast<std::size_t>(monitor.x) * 4,
+				stride);
+		}
+
+		return Frame(monitor.width, monitor.height, std::move(pixels));
+	}
+}
+
+std::vector<Monitor> FrameSource::monitors()
+{
+	auto frame = next_frame();
+
+	return { Monitor{ 0, 0, frame.width(), frame.height(), true } };
+}
+
+std::vector<Frame> FrameSource::next_monitor_frames(const std::vector<Monitor>& monitors)
+{
+	std::vector<Frame> frames;
+	auto               frame = next_frame();
+
+	frames.reserve(monitors.size());
+	for (const auto& monitor : monitors)
+		frames.push_back(crop(frame, monitor));
+
+	return frames;
+}
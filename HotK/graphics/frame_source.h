@@ -0,0 +1,38 @@
+#pragma once
+
+#include "frame.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace hotk::graphics::frame_source {
+	using hotk::graphics::frame::Frame;
+
+	// Area of one monitor within the frames next_frame returns, so x and y
+	// are never negative even for monitors left of or above the primary.
+	struct Monitor {
+		int32_t x;
+		int32_t y;
+		int32_t width;
+		int32_t height;
+		bool    primary;
+	};
+
+	// Produces the frames handed to the encoders. Implementations must be
+	// safe to call from several threads at once since every TcpClient runs
+	// its handlers on its own io thread.
+	class FrameSource {
+	public:
+		virtual ~FrameSource() = default;
+
+		virtual Frame next_frame() = 0;
+
+		// Monitors in the order requests number them. The default reports
+		// a single one covering a whole frame, it grabs one to learn the size.
+		virtual std::vector<Monitor> monitors();
+
+		// One frame per monitor, taken at the same moment as far as the
+		// source allows. The default crops them out of a single next_frame.
+		virtual std::vector<Frame> next_monitor_frames(const std::vector<Monitor>&);
+	};
+}
@@ -0,0 +1,195 @@
+#include "i420.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HOTK_I420_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace i420 = hotk::graphics::i420;
+
+using i420::I420Image;
+using hotk::graphics::frame::Frame;
+
+namespace {
+	// BT.601 studio swing in 8 bit fixed point, in the B G R order of the
+	// pixels. Both paths use the same integer maths so they agree exactly.
+	const int luma_b = 25;
+	const int luma_g = 129;
+	const int luma_r = 66;
+	const int u_b    = 112;
+	const int u_g    = -74;
+	const int u_r    = -38;
+	const int v_b    = -18;
+	const int v_g    = -94;
+	const int v_r    = 112;
+
+	uint8_t channel(const std::byte* pixel, int index)
+	{
+		return static_cast<uint8_t>(pixel[index]);
+	}
+
+	uint8_t luma(const std::byte* pixel)
+	{
+		int sum = luma_b * channel(pixel, 0) + luma_g * channel(pixel, 1) + luma_r * channel(pixel, 2);
+
+		return static_cast<uint8_t>(((sum + 128) >> 8) + 16);
+	}
+
+	// Takes the channel sums of a 2x2 block.
+	uint8_t chroma(int b, int g, int r, int coeff_b, int coeff_g, int coeff_r)
+	{
+		return static_cast<uint8_t>(((coeff_b * b + coeff_g * g + coeff_r * r + 512) >> 10) + 128);
+	}
+
+#if defined(HOTK_I420_SSE2)
+	// Adds the two int32 halves of every pixel in a and b, giving one sum
+	// per pixel: a0+a1, a2+a3, b0+b1, b2+b3.
+	__m128i add_pairs(__m128i a, __m128i b)
+	{
+		__m128  fa   = _mm_castsi128_ps(a);
+		__m128  fb   = _mm_castsi128_ps(b);
+		__m128i even = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(2, 0, 2, 0)));
+		__m128i odd  = _mm_castps_si128(_mm_shuffle_ps(fa, fb, _MM_SHUFFLE(3, 1, 3, 1)));
+
+		return _mm_add_epi32(even, odd);
+	}
+
+	// Eight pixels to eight luma samples.
+	void luma_8(const std::byte* src, uint8_t* dst)
+	{
+		const __m128i zero  = _mm_setzero_si128();
+		const __m128i coeff = _mm_setr_epi16(luma_b, luma_g, luma_r, 0, luma_b, luma_g, luma_r, 0);
+		const __m128i round = _mm_set1_epi32(128);
+
+		__m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+		__m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+
+		__m128i y0 = add_pairs(
+			_mm_madd_epi16(_mm_unpacklo_epi8(p0, zero), coeff),
+			_mm_madd_epi16(_mm_unpackhi_epi8(p0, zero), coeff));
+		__m128i y1 = add_pairs(
+			_mm_madd_epi16(_mm_unpacklo_epi8(p1, zero), coeff),
+			_mm_madd_epi16(_mm_unpackhi_epi8(p1, zero), coeff));
+
+		y0 = _mm_srai_epi32(_mm_add_epi32(y0, round), 8);
+		y1 = _mm_srai_epi32(_mm_add_epi32(y1, round), 8);
+
+		__m128i y = _mm_add_epi16(_mm_packs_epi32(y0, y1), _mm_set1_epi16(16));
+
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst), _mm_packus_epi16(y, y));
+	}
+
+	// Eight pixels of two rows to four u and four v samples.
+	void chroma_8(const std::byte* row0, const std::byte* row1, uint8_t* u, uint8_t* v)
+	{
+		const __m128i zero    = _mm_setzero_si128();
+		const __m128i coeff_u = _mm_setr_epi16(u_b, u_g, u_r, 0, u_b, u_g, u_r, 0);
+		const __m128i coeff_v = _mm_setr_epi16(v_b, v_g, v_r, 0, v_b, v_g, v_r, 0);
+		const __m128i round   = _mm_set1_epi32(512);
+
+		__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0));
+		__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 16));
+		__m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1));
+		__m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 16));
+
+		// Column sums, two pixels per register.
+		__m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+		__m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+		__m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+		__m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+		// Block sums, two blocks per register.
+		__m128i h0 = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+		__m128i h1 = _mm_add_epi16(_mm_unpacklo_epi64(s2, s3), _mm_unpackhi_epi64(s2, s3));
+
+		__m128i cu = add_pairs(_mm_madd_epi16(h0, coeff_u), _mm_madd_epi16(h1, coeff_u));
+		__m128i cv = add_pairs(_mm_madd_epi16(h0, coeff_v), _mm_madd_epi16(h1, coeff_v));
+
+		cu = _mm_srai_epi32(_mm_add_epi32(cu, round), 10);
+		cv = _mm_srai_epi32(_mm_add_epi32(cv, round), 10);
+
+		__m128i uv       = _mm_add_epi16(_mm_packs_epi32(cu, cv), _mm_set1_epi16(128));
+		__m128i bytes    = _mm_packus_epi16(uv, uv);
+		int32_t packed_u = _mm_cvtsi128_si32(bytes);
+		int32_t packed_v = _mm_cvtsi128_si32(_mm_srli_si128(bytes, 4));
+
+		std::memcpy(u, &packed_u, 4);
+		std::memcpy(v, &packed_v, 4);
+	}
+#endif
+
+	void luma_row(const std::byte* src, uint8_t* dst, int32_t width, int32_t padded_width)
+	{
+		int32_t x = 0;
+
+#if defined(HOTK_I420_SSE2)
+		for (; x + 8 <= width; x += 8)
+			luma_8(src + x * 4, dst + x);
+#endif
+
+		for (; x < width; x++)
+			dst[x] = luma(src + x * 4);
+
+		for (; x < padded_width; x++)
+			dst[x] = dst[width - 1];
+	}
+
+	void chroma_row(const std::byte* row0, const std::byte* row1, uint8_t* u, uint8_t* v, int32_t width, int32_t padded_width)
+	{
+		int32_t x = 0;
+
+#if defined(HOTK_I420_SSE2)
+		for (; x + 8 <= width; x += 8)
+			chroma_8(row0 + x * 4, row1 + x * 4, u + x / 2, v + x / 2);
+#endif
+
+		for (; x < padded_width; x += 2) {
+			const std::byte* pixels[] = {
+				row0 + std::min(x, width - 1) * 4,
+				row0 + std::min(x + 1, width - 1) * 4,
+				row1 + std::min(x, width - 1) * 4,
+				row1 + std::min(x + 1, width - 1) * 4,
+			};
+			int b = 0;
+			int g = 0;
+			int r = 0;
+
+			for (const auto* pixel : pixels) {
+				b += channel(pixel, 0);
+				g += channel(pixel, 1);
+				r += channel(pixel, 2);
+			}
+
+			u[x / 2] = chroma(b, g, r, u_b, u_g, u_r);
+			v[x / 2] = chroma(b, g, r, v_b, v_g, v_r);
+		}
+	}
+}
+
+void i420::bgra_to_i420(const Frame& frame, I420Image& image)
+{
+	const int32_t width  = frame.width();
+	const int32_t height = frame.height();
+
+	image.width  = (width + 1) & ~1;
+	image.height = (height + 1) & ~1;
+	image.y.resize(static_cast<std::size_t>(image.width) * image.height);
+	image.u.resize(image.chroma_width() * (image.height / 2));
+	image.v.resize(image.chroma_width() * (image.height / 2));
+
+	if (width == 0 || height == 0)
+		return;
+
+	for (int32_t y = 0; y < image.height; y += 2) {
+		const std::byte*  row0          = frame.row(y);
+		const std::byte*  row1          = frame.row(std::min(y + 1, height - 1));
+		const std::size_t chroma_offset = image.chroma_width() * (y / 2);
+
+		luma_row(row0, image.y.data() + static_cast<std::size_t>(image.width) * y, width, image.width);
+		luma_row(row1, image.y.data() + static_cast<std::size_t>(image.width) * (y + 1), width, image.width);
+		chroma_row(row0, row1, image.u.data() + chroma_offset, image.v.data() + chroma_offset, width, image.width);
+	}
+}
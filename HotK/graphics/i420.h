@@ -0,0 +1,30 @@
+#pragma once
+
+#include "frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::graphics::i420 {
+	using hotk::graphics::frame::Frame;
+
+	// Planar YUV 4:2:0 with BT.601 limited range, the input software video
+	// encoders take. Planes are stored top-down and tightly packed. The
+	// size is the frame's rounded up to even, odd frames repeat their last
+	// column and row.
+	struct I420Image {
+		int32_t              width  = 0;
+		int32_t              height = 0;
+		std::vector<uint8_t> y;
+		std::vector<uint8_t> u;
+		std::vector<uint8_t> v;
+
+		std::size_t chroma_width() const noexcept {
+			return static_cast<std::size_t>(width) / 2;
+		}
+	};
+
+	// Converts into image, reusing its planes when the size did not change.
+	void bgra_to_i420(const Frame&, I420Image& image);
+}
@@ -0,0 +1,131 @@
+#include "jpeg_encoder.h"
+#include "../errors/errors.h"
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <string>
+
+#include <jpeglib.h>
+
+namespace jpeg_encoder = hotk::graphics::jpeg_encoder;
+
+using hotk::errors::ErrorCode;
+using hotk::graphics::frame::Frame;
+
+namespace {
+	struct ErrorManager {
+		jpeg_error_mgr manager;
+		jmp_buf        jump_buffer;
+		char           message[JMSG_LENGTH_MAX];
+	};
+
+	// Compresses straight into the output vector instead of letting
+	// libjpeg malloc a buffer that would then have to be copied.
+	struct VectorDestination {
+		jpeg_destination_mgr    manager;
+		std::vector<std::byte>* output;
+	};
+
+	void on_error_exit(j_common_ptr cinfo)
+	{
+		auto* errors = reinterpret_cast<ErrorManager*>(cinfo->err);
+
+		(*cinfo->err->format_message)(cinfo, errors->message);
+		longjmp(errors->jump_buffer, 1);
+	}
+
+	void on_output_message(j_common_ptr)
+	{
+		// Warnings are not worth a line per frame.
+	}
+
+	void on_init_destination(j_compress_ptr cinfo)
+	{
+		auto* destination = reinterpret_cast<VectorDestination*>(cinfo->dest);
+
+		destination->manager.next_output_byte = reinterpret_cast<JOCTET*>(destination->output->data());
+		destination->manager.free_in_buffer   = destination->output->size();
+	}
+
+	boolean on_empty_output_buffer(j_compress_ptr cinfo)
+	{
+		auto*       destination = reinterpret_cast<VectorDestination*>(cinfo->dest);
+		std::size_t used        = destination->output->size();
+
+		// libjpeg expects the whole buffer to have been consumed here.
+		destination->output->resize(used * 2);
+		destination->manager.next_output_byte = reinterpret_cast<JOCTET*>(destination->output->data() + used);
+		destination->manager.free_in_buffer   = destination->output->size() - used;
+
+		return TRUE;
+	}
+
+	void on_term_destination(j_compress_ptr cinfo)
+	{
+		auto* destination = reinterpret_cast<VectorDestination*>(cinfo->dest);
+
+		destination->output->resize(destination->output->size() - destination->manager.free_in_buffer);
+	}
+}
+
+std::vector<std::byte> jpeg_encoder::encode_jpeg(const Frame& frame, const JpegOptions& options)
+{
+	jpeg_compress_struct     cinfo;
+	ErrorManager             errors;
+	VectorDestination        destination;
+	std::vector<std::byte>   output;
+	std::vector<JSAMPROW>    rows;
+
+	cinfo.err                     = jpeg_std_error(&errors.manager);
+	errors.manager.error_exit     = on_error_exit;
+	errors.manager.output_message = on_output_message;
+
+	if (setjmp(errors.jump_buffer)) {
+		jpeg_destroy_compress(&cinfo);
+
+		std::string message = std::string("encode jpeg: ") + errors.message;
+		throw ErrorCode(1, message);
+	}
+
+	jpeg_create_compress(&cinfo);
+
+	// Screens usually land well below a tenth of the raw size.
+	output.resize(std::max<std::size_t>(frame.size() / 8, 64 * 1024));
+	destination.output                       = &output;
+	destination.manager.init_destination     = on_init_destination;
+	destination.manager.empty_output_buffer  = on_empty_output_buffer;
+	destination.manager.term_destination     = on_term_destination;
+	cinfo.dest                               = &destination.manager;
+
+	cinfo.image_width      = static_cast<JDIMENSION>(frame.width());
+	cinfo.image_height     = static_cast<JDIMENSION>(frame.height());
+	cinfo.input_components = 4;
+	cinfo.in_color_space   = JCS_EXT_BGRA;
+
+	jpeg_set_defaults(&cinfo);
+	jpeg_set_quality(&cinfo, std::clamp(options.quality, 1, 100), TRUE);
+	cinfo.optimize_coding = options.optimize_huffman ? TRUE : FALSE;
+
+	int luma_sampling = options.subsampling == ChromaSubsampling::Yuv420 ? 2 : 1;
+	cinfo.comp_info[0].h_samp_factor = luma_sampling;
+	cinfo.comp_info[0].v_samp_factor = luma_sampling;
+	cinfo.comp_info[1].h_samp_factor = 1;
+	cinfo.comp_info[1].v_samp_factor = 1;
+	cinfo.comp_info[2].h_samp_factor = 1;
+	cinfo.comp_info[2].v_samp_factor = 1;
+
+	// Bottom-up DIB rows are handed over in top-down order.
+	rows.reserve(frame.height());
+	for (int32_t y = 0; y < frame.height(); y++)
+		rows.push_back(reinterpret_cast<JSAMPROW>(const_cast<std::byte*>(frame.row(y))));
+
+	jpeg_start_compress(&cinfo, TRUE);
+	while (cinfo.next_scanline < cinfo.image_height)
+		jpeg_write_scanlines(&cinfo, rows.data() + cinfo.next_scanline, cinfo.image_height - cinfo.next_scanline);
+
+	jpeg_finish_compress(&cinfo);
+	jpeg_destroy_compress(&cinfo);
+
+	return output;
+}
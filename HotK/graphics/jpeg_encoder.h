@@ -0,0 +1,28 @@
+#pragma once
+
+#include "frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::graphics::jpeg_encoder {
+	using hotk::graphics::frame::Frame;
+
+	enum class ChromaSubsampling : uint8_t {
+		Yuv444 = 0,
+		Yuv420,
+	};
+
+	struct JpegOptions {
+		int               quality          = 80;
+		ChromaSubsampling subsampling      = ChromaSubsampling::Yuv420;
+		// Two passes over the data for smaller files, otherwise the
+		// standard Huffman tables are used.
+		bool              optimize_huffman = false;
+	};
+
+	// Lossy encode through libjpeg-turbo. The BGRA rows are fed to the
+	// SIMD colour converter as they are, without swizzling first.
+	std::vector<std::byte> encode_jpeg(const Frame&, const JpegOptions&);
+}
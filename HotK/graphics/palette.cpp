@@ -0,0 +1,166 @@
+#include "palette.h"
+
+#include <array>
+#include <cstring>
+
+namespace palette = hotk::graphics::palette;
+
+using hotk::graphics::frame::Frame;
+using palette::IndexedImage;
+
+namespace {
+	// Open addressing with twice as many slots as colours keeps probes short.
+	const std::size_t table_size = palette::max_colours * 2;
+	const uint32_t    empty_slot = 0xFFFFFFFF;
+
+	class ColourTable {
+	private:
+		std::array<uint32_t, table_size> _keys;
+		std::array<uint8_t, table_size>  _values;
+		std::vector<uint32_t>&           _colours;
+
+	public:
+		ColourTable(std::vector<uint32_t>& colours)
+			: _colours(colours)
+		{
+			_keys.fill(empty_slot);
+		}
+
+		// Returns the palette index of the colour, adding it if needed.
+		// Returns -1 once the palette is full.
+		int index_of(uint32_t colour)
+		{
+			std::size_t slot = (colour * 0x9E3779B1u) >> (32 - 9);
+
+			for (;; slot = (slot + 1) & (table_size - 1)) {
+				if (_keys[slot] == colour)
+					return _values[slot];
+
+				if (_keys[slot] != empty_slot)
+					continue;
+
+				if (_colours.size() >= palette::max_colours)
+					return -1;
+
+				_keys[slot]   = colour;
+				_values[slot] = static_cast<uint8_t>(_colours.size());
+				_colours.push_back(colour);
+				return _values[slot];
+			}
+		}
+	};
+
+	static_assert(table_size == 1 << 9, "Palette Error: colour hash assumes a 512 slot table!");
+
+	int bit_depth_for(std::size_t colours)
+	{
+		if (colours <= 2)
+			return 1;
+		if (colours <= 4)
+			return 2;
+		if (colours <= 16)
+			return 4;
+
+		return 8;
+	}
+
+	// Packs 8 bit indices in place into the final bit depth.
+	void pack_indices(IndexedImage& image)
+	{
+		const std::size_t width    = static_cast<std::size_t>(image.width);
+		const std::size_t row_size = image.row_size();
+
+		if (image.bit_depth == 8)
+			return;
+
+		const int per_byte = 8 / image.bit_depth;
+
+		for (int32_t y = 0; y < image.height; y++) {
+			const uint8_t* source = image.indices.data() + width * y;
+			uint8_t*       target = image.indices.data() + row_size * y;
+
+			for (std::size_t byte = 0; byte < row_size; byte++) {
+				uint8_t packed = 0;
+
+				for (int i = 0; i < per_byte; i++) {
+					std::size_t x     = byte * per_byte + i;
+					uint8_t     index = x < width ? source[x] : 0;
+
+					packed |= static_cast<uint8_t>(index << (8 - image.bit_depth * (i + 1)));
+				}
+
+				target[byte] = packed;
+			}
+		}
+
+		image.indices.resize(row_size * image.height);
+	}
+
+	bool build_palette(const Frame& frame, IndexedImage& image, uint32_t mask, uint32_t rounding)
+	{
+		const std::size_t width = static_cast<std::size_t>(frame.width());
+
+		image.width  = frame.width();
+		image.height = frame.height();
+		image.colours.clear();
+		image.indices.resize(width * frame.height());
+
+		ColourTable table(image.colours);
+		uint32_t    previous_colour = empty_slot;
+		uint8_t     previous_index  = 0;
+
+		for (int32_t y = 0; y < frame.height(); y++) {
+			const std::byte* row     = frame.row(y);
+			uint8_t*         indices = image.indices.data() + width * y;
+
+			for (std::size_t x = 0; x < width; x++) {
+				uint32_t pixel;
+
+				std::memcpy(&pixel, row + x * 4, 4);
+				pixel &= mask;
+
+				// Flat UI is mostly long runs of one colour.
+				if (pixel != previous_colour) {
+					int index = table.index_of(pixel);
+					if (index < 0)
+						return false;
+
+					previous_colour = pixel;
+					previous_index  = static_cast<uint8_t>(index);
+				}
+
+				indices[x] = previous_index;
+			}
+		}
+
+		// Centre quantized colours in the range they stand for.
+		for (auto& colour : image.colours)
+			colour |= rounding;
+
+		image.bit_depth = bit_depth_for(image.colours.size());
+		pack_indices(image);
+
+		return true;
+	}
+}
+
+bool palette::find_exact_palette(const Frame& frame, IndexedImage& image)
+{
+	// BGRA read as a little endian uint32_t is 0xAARRGGBB.
+	return build_palette(frame, image, 0x00FFFFFF, 0);
+}
+
+bool palette::find_quantized_palette(const Frame& frame, IndexedImage& image)
+{
+	for (uint32_t dropped_bits = 1; dropped_bits <= 4; dropped_bits++) {
+		uint32_t channel_mask = (0xFFu << dropped_bits) & 0xFFu;
+		uint32_t mask         = channel_mask | (channel_mask << 8) | (channel_mask << 16);
+		uint32_t half         = 1u << (dropped_bits - 1);
+		uint32_t rounding     = half | (half << 8) | (half << 16);
+
+		if (build_palette(frame, image, mask, rounding))
+			return true;
+	}
+
+	return false;
+}
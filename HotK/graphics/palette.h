@@ -0,0 +1,39 @@
+#pragma once
+
+#include "frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::graphics::palette {
+	using hotk::graphics::frame::Frame;
+
+	const std::size_t max_colours = 256;
+
+	// Frame rewritten as indices into at most 256 colours, ready to be
+	// stored as an indexed PNG.
+	struct IndexedImage {
+		int32_t               width;
+		int32_t               height;
+		// 1, 2, 4 or 8, the smallest depth that can address every colour.
+		int                   bit_depth;
+		// 0x00RRGGBB, alpha is ignored since desktop captures are opaque.
+		std::vector<uint32_t> colours;
+		// Packed rows, top to bottom, each padded to a whole byte.
+		std::vector<uint8_t>  indices;
+
+		std::size_t row_size() const noexcept {
+			return (static_cast<std::size_t>(width) * bit_depth + 7) / 8;
+		}
+	};
+
+	// Builds the exact palette of the frame. Gives up and returns false as
+	// soon as the 257th distinct colour shows up, so frames that do not
+	// qualify cost only a partial pass.
+	bool find_exact_palette(const Frame&, IndexedImage&);
+
+	// For frames that are close: retries with progressively fewer bits per
+	// channel, up to 4, until the frame fits in 256 colours. Lossy.
+	bool find_quantized_palette(const Frame&, IndexedImage&);
+}
@@ -0,0 +1,208 @@
+#include "png_encoder.h"
+#include "palette.h"
+#include "png_writer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <iostream>
+#include <iterator>
+#include <zlib.h>
+#include <png.h>
+
+namespace png_encoder = hotk::graphics::png_encoder;
+
+using hotk::graphics::frame::Frame;
+using hotk::graphics::palette::IndexedImage;
+using hotk::graphics::palette::find_exact_palette;
+using hotk::graphics::palette::find_quantized_palette;
+
+namespace png_writer = hotk::graphics::png_writer;
+
+void ss_png_write_row_callback(png_structp png_ptr, png_uint_32 row, int pass)
+{
+	if (png_ptr == NULL) {
+		std::cout << "WRITE_CALLBACK: png_ptr is null\n";
+		return;
+	}
+
+	std::cout << "--------------------------------\n";
+	std::cout << "row: " << row << "\n";
+	std::cout << "pass: " << pass << "\n";
+}
+
+void ss_png_on_err(png_structp, png_const_charp error_msg)
+{
+	std::cout << "user error fn: " << error_msg << "\n";
+}
+
+void ss_png_on_warn(png_structp, png_const_charp warning_msg)
+{
+	std::cout << "user warning fn: " << warning_msg << "\n";
+}
+
+void ss_png_on_write_to_vec(png_structp png_ptr, png_bytep data, png_size_t length)
+{
+	// TODO: 
+	//    Catch possible bad_alloc exceptions that might cause the png C code
+	//    to return unexpectedly and cause memory leaks on perform_png_conversion.
+	if (png_ptr == NULL)
+		return;
+
+	auto* output = reinterpret_cast<std::vector<std::byte>*>(png_get_io_ptr(png_ptr));
+
+	assert(output != nullptr);
+	std::copy(
+		reinterpret_cast<std::byte*>(data), 
+		reinterpret_cast<std::byte*>(data) + length,
+		std::back_inserter(*output));
+}
+
+void ss_png_on_flush_to_vec(png_structp)
+{
+	// No need to flush to a vector.
+}
+
+std::vector<std::byte*> get_bitmap_rows(const Frame& frame)
+{
+	assert(frame.height() > 0 || frame.width() > 0);
+	auto rows = std::vector<std::byte*>();
+
+	rows.reserve(frame.height());
+
+	// png expects rows from top to bottom.
+	for (int32_t y = 0; y < frame.height(); y++)
+		rows.push_back(const_cast<std::byte*>(frame.row(y)));
+
+	return rows;
+}
+
+std::vector<std::byte*> get_indexed_rows(IndexedImage& image)
+{
+	auto rows = std::vector<std::byte*>();
+
+	rows.reserve(image.height);
+
+	for (int32_t y = 0; y < image.height; y++)
+		rows.push_back(reinterpret_cast<std::byte*>(image.indices.data() + image.row_size() * y));
+
+	return rows;
+}
+
+struct PngLayout {
+	int32_t                      width;
+	int32_t                      height;
+	int                          bit_depth;
+	int                          color_type;
+	int                          transforms;
+	const std::vector<uint32_t>* palette;
+};
+
+std::vector<std::byte> perform_png_conversion(const PngLayout& layout, std::vector<std::byte*>& rows)
+{
+	std::vector<std::byte> output;
+	std::vector<png_color> palette;
+	png_voidp              error_ptr   = NULL;
+	png_structp            png_ptr     = NULL;
+	png_infop              info_ptr    = NULL;
+
+	png_ptr = png_create_write_struct(
+		PNG_LIBPNG_VER_STRING,
+		error_ptr,
+		ss_png_on_err,
+		ss_png_on_warn);
+
+	if (!png_ptr)
+		throw std::exception("failed to create a png write struct!");
+
+	info_ptr = png_create_info_struct(png_ptr);
+	if (!info_ptr) {
+		png_destroy_write_struct(&png_ptr, (png_infopp)nullptr);
+		throw std::exception("to png: failed to create info struct");
+	}
+
+	if (setjmp(png_jmpbuf(png_ptr))) {
+		png_destroy_write_struct(&png_ptr, (png_infopp)nullptr);
+		throw std::exception("to png: failed to assign jmpbuf");
+	}
+
+	png_set_write_fn(
+		png_ptr,
+		reinterpret_cast<void*>(&output),
+		ss_png_on_write_to_vec,
+		ss_png_on_flush_to_vec);
+	png_set_write_status_fn(png_ptr, ss_png_write_row_callback);
+	png_set_IHDR(
+		png_ptr,
+		info_ptr,
+		layout.width,
+		layout.height,
+		layout.bit_depth,
+		layout.color_type,
+		PNG_INTERLACE_NONE,
+		PNG_COMPRESSION_TYPE_DEFAULT,
+		PNG_FILTER_TYPE_DEFAULT);
+
+	if (layout.palette != nullptr) {
+		for (uint32_t colour : *layout.palette) {
+			palette.push_back({
+				static_cast<png_byte>(colour >> 16),
+				static_cast<png_byte>(colour >> 8),
+				static_cast<png_byte>(colour) });
+		}
+
+		png_set_PLTE(png_ptr, info_ptr, palette.data(), static_cast<int>(palette.size()));
+	}
+
+	png_set_filter(png_ptr, 0, PNG_FILTER_NONE);
+	png_set_compression_level(png_ptr, Z_BEST_COMPRESSION);
+	png_set_rows(png_ptr, info_ptr, reinterpret_cast<png_bytepp>(rows.data()));
+
+	png_write_png(png_ptr, info_ptr, layout.transforms, NULL);
+	png_write_end(png_ptr, info_ptr);
+	png_destroy_write_struct(&png_ptr, &info_ptr);
+
+	return output;
+}
+
+// Few colours: store indices, far less data for deflate to chew on.
+bool find_palette(const Frame& frame, const png_encoder::PngOptions& options, IndexedImage& image)
+{
+	return options.detect_palette
+		&& (find_exact_palette(frame, image) || (options.quantize && find_quantized_palette(frame, image)));
+}
+
+std::vector<std::byte> png_encoder::encode_png(const Frame& frame, const PngOptions& options)
+{
+	IndexedImage           image;
+	std::vector<std::byte> output;
+
+	if (find_palette(frame, options, image))
+		png_writer::write_png(image, output, options.compression_level);
+	else
+		png_writer::write_png(frame, output, options.compression_level);
+
+	return output;
+}
+
+std::vector<std::byte> png_encoder::encode_png_libpng(const Frame& frame, const PngOptions& options)
+{
+	IndexedImage image;
+
+	if (find_palette(frame, options, image)) {
+		auto      rows   = get_indexed_rows(image);
+		PngLayout layout = {
+			image.width, image.height, image.bit_depth, PNG_COLOR_TYPE_PALETTE, PNG_TRANSFORM_IDENTITY, &image.colours
+		};
+
+		return perform_png_conversion(layout, rows);
+	}
+
+	// Transform bitmap's little endian to big endian bytes using a transform.
+	auto      rows   = get_bitmap_rows(frame);
+	PngLayout layout = {
+		frame.width(), frame.height(), 8, PNG_COLOR_TYPE_RGBA, PNG_TRANSFORM_BGR, nullptr
+	};
+
+	return perform_png_conversion(layout, rows);
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "frame.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace hotk::graphics::png_encoder {
+	using hotk::graphics::frame::Frame;
+
+	struct PngOptions {
+		// Frames with 256 colours or less are written as indexed PNGs.
+		bool detect_palette = true;
+		// Also reduce frames that are close to 256 colours, lossy.
+		bool quantize       = false;
+		// libdeflate level, 1 to 12.
+		int  compression_level = 6;
+	};
+
+	// Encodes with the in-tree png_writer.
+	std::vector<std::byte> encode_png(const Frame&, const PngOptions& = PngOptions());
+
+	// Former libpng based encoder, kept as a reference for the codec bench.
+	// Ignores compression_level and always uses zlib's best compression.
+	std::vector<std::byte> encode_png_libpng(const Frame&, const PngOptions& = PngOptions());
+}
@@ -0,0 +1,386 @@
+#include "png_writer.h"
+#include "../errors/errors.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <libdeflate.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HOTK_PNG_WRITER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace png_writer = hotk::graphics::png_writer;
+
+using hotk::errors::ErrorCode;
+using hotk::graphics::frame::Frame;
+using hotk::graphics::palette::IndexedImage;
+
+namespace {
+	enum class FilterType : uint8_t {
+		None = 0,
+		Sub,
+		Up,
+		Average,
+		Paeth,
+	};
+
+	const int         rgb_bytes_per_pixel = 3;
+	const uint8_t     color_type_rgb      = 2;
+	const uint8_t     color_type_palette  = 3;
+	const std::array<uint8_t, 8> signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	// Zeroed bytes in front of every row buffer so the left neighbours of
+	// the first pixel read as 0 without special casing.
+	const std::size_t row_padding = 16;
+
+	// One compressor per thread and level, allocating one costs more than
+	// deflating a small frame.
+	class Compressor {
+	private:
+		libdeflate_compressor* _compressor;
+		int                    _level;
+
+	public:
+		Compressor()
+			: _compressor(nullptr)
+			, _level(-1)
+		{
+		}
+
+		~Compressor()
+		{
+			if (_compressor != nullptr)
+				libdeflate_free_compressor(_compressor);
+		}
+
+		libdeflate_compressor* get(int level)
+		{
+			if (_compressor != nullptr && _level == level)
+				return _compressor;
+
+			if (_compressor != nullptr)
+				libdeflate_free_compressor(_compressor);
+
+			_compressor = libdeflate_alloc_compressor(level);
+			_level      = level;
+
+			if (_compressor == nullptr)
+				throw ErrorCode(1, "png writer: failed to allocate the deflate compressor");
+
+			return _compressor;
+		}
+	};
+
+	uint8_t paeth_predictor(int a, int b, int c)
+	{
+		int pa = std::abs(b - c);
+		int pb = std::abs(a - c);
+		int pc = std::abs(a + b - 2 * c);
+
+		if (pa <= pb && pa <= pc)
+			return static_cast<uint8_t>(a);
+
+		return static_cast<uint8_t>(pb <= pc ? b : c);
+	}
+
+	// Filtered bytes are judged as signed values: small deltas in either
+	// direction compress well.
+	uint64_t signed_cost(uint8_t value)
+	{
+		return value < 128 ? value : 256 - value;
+	}
+
+#if defined(HOTK_PNG_WRITER_SSE2)
+	__m128i abs_epi16(__m128i value)
+	{
+		return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+	}
+
+	__m128i select(__m128i mask, __m128i if_set, __m128i if_clear)
+	{
+		return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+	}
+
+	uint64_t signed_cost(__m128i value)
+	{
+		__m128i absolute = _mm_min_epu8(value, _mm_sub_epi8(_mm_setzero_si128(), value));
+		__m128i sums     = _mm_sad_epu8(absolute, _mm_setzero_si128());
+
+		return static_cast<uint64_t>(_mm_cvtsi128_si32(sums)) + static_cast<uint64_t>(_mm_extract_epi16(sums, 4));
+	}
+
+	__m128i paeth_epi16(__m128i a, __m128i b, __m128i c)
+	{
+		__m128i bc = _mm_sub_epi16(b, c);
+		__m128i ac = _mm_sub_epi16(a, c);
+		__m128i pa = abs_epi16(bc);
+		__m128i pb = abs_epi16(ac);
+		__m128i pc = abs_epi16(_mm_add_epi16(bc, ac));
+
+		__m128i not_a = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+		__m128i use_c = _mm_and_si128(not_a, _mm_cmpgt_epi16(pb, pc));
+
+		return select(not_a, select(use_c, c, b), a);
+	}
+#endif
+
+	// Every filter reads cur[i - bpp] and prev[i - bpp], which the row
+	// padding makes valid for the first pixel. Returns the row's cost.
+	uint64_t filter_none(const uint8_t* cur, const uint8_t*, uint8_t* out, std::size_t size)
+	{
+		uint64_t cost = 0;
+
+		std::memcpy(out, cur, size);
+		for (std::size_t i = 0; i < size; i++)
+			cost += signed_cost(cur[i]);
+
+		return cost;
+	}
+
+	uint64_t filter_sub(const uint8_t* cur, const uint8_t*, uint8_t* out, std::size_t size)
+	{
+		const int   bpp  = rgb_bytes_per_pixel;
+		uint64_t    cost = 0;
+		std::size_t i    = 0;
+
+#if defined(HOTK_PNG_WRITER_SSE2)
+		for (; i + 16 <= size; i += 16) {
+			__m128i x    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i));
+			__m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i - bpp));
+			__m128i d    = _mm_sub_epi8(x, left);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), d);
+			cost += signed_cost(d);
+		}
+#endif
+
+		for (; i < size; i++) {
+			out[i] = static_cast<uint8_t>(cur[i] - cur[i - bpp]);
+			cost  += signed_cost(out[i]);
+		}
+
+		return cost;
+	}
+
+	uint64_t filter_up(const uint8_t* cur, const uint8_t* prev, uint8_t* out, std::size_t size)
+	{
+		uint64_t    cost = 0;
+		std::size_t i    = 0;
+
+#if defined(HOTK_PNG_WRITER_SSE2)
+		for (; i + 16 <= size; i += 16) {
+			__m128i x  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i));
+			__m128i up = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+			__m128i d  = _mm_sub_epi8(x, up);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), d);
+			cost += signed_cost(d);
+		}
+#endif
+
+		for (; i < size; i++) {
+			out[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+			cost  += signed_cost(out[i]);
+		}
+
+		return cost;
+	}
+
+	uint64_t filter_paeth(const uint8_t* cur, const uint8_t* prev, uint8_t* out, std::size_t size)
+	{
+		const int   bpp  = rgb_bytes_per_pixel;
+		uint64_t    cost = 0;
+		std::size_t i    = 0;
+
+#if defined(HOTK_PNG_WRITER_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+
+		// Encoding knows every neighbour up front, so unlike decoding the
+		// whole row can be predicted in parallel.
+		for (; i + 16 <= size; i += 16) {
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i));
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + i - bpp));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + i - bpp));
+
+			__m128i low  = paeth_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+			__m128i high = paeth_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+			__m128i d    = _mm_sub_epi8(x, _mm_packus_epi16(low, high));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), d);
+			cost += signed_cost(d);
+		}
+#endif
+
+		for (; i < size; i++) {
+			out[i] = static_cast<uint8_t>(cur[i] - paeth_predictor(cur[i - bpp], prev[i], prev[i - bpp]));
+			cost  += signed_cost(out[i]);
+		}
+
+		return cost;
+	}
+
+	void bgra_to_rgb(const std::byte* bgra, uint8_t* rgb, int32_t width)
+	{
+		const auto* source = reinterpret_cast<const uint8_t*>(bgra);
+
+		for (int32_t x = 0; x < width; x++) {
+			rgb[0] = source[2];
+			rgb[1] = source[1];
+			rgb[2] = source[0];
+
+			rgb    += 3;
+			source += 4;
+		}
+	}
+
+	void put_uint32(std::byte* target, uint32_t value)
+	{
+		target[0] = static_cast<std::byte>(value >> 24);
+		target[1] = static_cast<std::byte>(value >> 16);
+		target[2] = static_cast<std::byte>(value >> 8);
+		target[3] = static_cast<std::byte>(value);
+	}
+
+	// Appends a whole chunk whose data is already known.
+	void write_chunk(std::vector<std::byte>& output, const char* type, const uint8_t* data, std::size_t size)
+	{
+		std::size_t start = output.size();
+
+		output.resize(start + 12 + size);
+		put_uint32(output.data() + start, static_cast<uint32_t>(size));
+		std::memcpy(output.data() + start + 4, type, 4);
+		if (size > 0)
+			std::memcpy(output.data() + start + 8, data, size);
+
+		uint32_t crc = libdeflate_crc32(0, output.data() + start + 4, 4 + size);
+		put_uint32(output.data() + start + 8 + size, crc);
+	}
+
+	void write_header(std::vector<std::byte>& output, int32_t width, int32_t height, uint8_t bit_depth, uint8_t color_type)
+	{
+		std::array<uint8_t, 13> ihdr = {};
+
+		put_uint32(reinterpret_cast<std::byte*>(ihdr.data()), static_cast<uint32_t>(width));
+		put_uint32(reinterpret_cast<std::byte*>(ihdr.data() + 4), static_cast<uint32_t>(height));
+		ihdr[8]  = bit_depth;
+		ihdr[9]  = color_type;
+		// Compression, filter and interlace methods are all 0.
+
+		output.insert(output.end(),
+			reinterpret_cast<const std::byte*>(signature.data()),
+			reinterpret_cast<const std::byte*>(signature.data()) + signature.size());
+		write_chunk(output, "IHDR", ihdr.data(), ihdr.size());
+	}
+
+	// Deflates the filtered rows straight into the output as one IDAT.
+	void write_image_data(std::vector<std::byte>& output, const std::vector<uint8_t>& filtered, int compression_level)
+	{
+		thread_local Compressor compressor;
+
+		auto*       deflater = compressor.get(compression_level);
+		std::size_t bound    = libdeflate_zlib_compress_bound(deflater, filtered.size());
+		std::size_t start    = output.size();
+
+		output.resize(start + 12 + bound);
+
+		std::size_t size = libdeflate_zlib_compress(deflater,
+			filtered.data(), filtered.size(), output.data() + start + 8, bound);
+
+		if (size == 0)
+			throw ErrorCode(1, "png writer: deflate output exceeded its bound");
+
+		put_uint32(output.data() + start, static_cast<uint32_t>(size));
+		std::memcpy(output.data() + start + 4, "IDAT", 4);
+
+		uint32_t crc = libdeflate_crc32(0, output.data() + start + 4, 4 + size);
+		put_uint32(output.data() + start + 8 + size, crc);
+
+		output.resize(start + 12 + size);
+	}
+}
+
+void png_writer::write_png(const Frame& frame, std::vector<std::byte>& output, int compression_level)
+{
+	using Filter = uint64_t(*)(const uint8_t*, const uint8_t*, uint8_t*, std::size_t);
+
+	const std::array<std::pair<FilterType, Filter>, 4> filters = { {
+		{ FilterType::None, filter_none },
+		{ FilterType::Sub, filter_sub },
+		{ FilterType::Up, filter_up },
+		{ FilterType::Paeth, filter_paeth },
+	} };
+
+	const std::size_t row_size = static_cast<std::size_t>(frame.width()) * rgb_bytes_per_pixel;
+
+	// Reused between calls on the same thread, frames rarely change size.
+	thread_local std::vector<uint8_t> filtered;
+	thread_local std::vector<uint8_t> rows;
+	thread_local std::vector<uint8_t> candidates;
+
+	filtered.resize((row_size + 1) * frame.height());
+	rows.assign(2 * (row_padding + row_size), 0);
+	candidates.resize(filters.size() * row_size);
+
+	uint8_t* prev = rows.data() + row_padding;
+	uint8_t* cur  = rows.data() + 2 * row_padding + row_size;
+
+	for (int32_t y = 0; y < frame.height(); y++) {
+		uint8_t* target    = filtered.data() + (row_size + 1) * y;
+		uint64_t best_cost = UINT64_MAX;
+		std::size_t best   = 0;
+
+		bgra_to_rgb(frame.row(y), cur, frame.width());
+
+		for (std::size_t i = 0; i < filters.size(); i++) {
+			uint64_t cost = filters[i].second(cur, prev, candidates.data() + i * row_size, row_size);
+
+			if (cost < best_cost) {
+				best_cost = cost;
+				best      = i;
+			}
+		}
+
+		target[0] = static_cast<uint8_t>(filters[best].first);
+		std::memcpy(target + 1, candidates.data() + best * row_size, row_size);
+
+		std::swap(prev, cur);
+	}
+
+	write_header(output, frame.width(), frame.height(), 8, color_type_rgb);
+	write_image_data(output, filtered, compression_level);
+	write_chunk(output, "IEND", nullptr, 0);
+}
+
+void png_writer::write_png(const IndexedImage& image, std::vector<std::byte>& output, int compression_level)
+{
+	const std::size_t row_size = image.row_size();
+
+	thread_local std::vector<uint8_t> filtered;
+	std::vector<uint8_t>              palette;
+
+	filtered.resize((row_size + 1) * image.height);
+	for (int32_t y = 0; y < image.height; y++) {
+		uint8_t* target = filtered.data() + (row_size + 1) * y;
+
+		target[0] = static_cast<uint8_t>(FilterType::None);
+		std::memcpy(target + 1, image.indices.data() + row_size * y, row_size);
+	}
+
+	palette.reserve(image.colours.size() * 3);
+	for (uint32_t colour : image.colours) {
+		palette.push_back(static_cast<uint8_t>(colour >> 16));
+		palette.push_back(static_cast<uint8_t>(colour >> 8));
+		palette.push_back(static_cast<uint8_t>(colour));
+	}
+
+	write_header(output, image.width, image.height, static_cast<uint8_t>(image.bit_depth), color_type_palette);
+	write_chunk(output, "PLTE", palette.data(), palette.size());
+	write_image_data(output, filtered, compression_level);
+	write_chunk(output, "IEND", nullptr, 0);
+}
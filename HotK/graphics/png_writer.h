@@ -0,0 +1,27 @@
+#pragma once
+
+#include "frame.h"
+#include "palette.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace hotk::graphics::png_writer {
+	using hotk::graphics::frame::Frame;
+	using hotk::graphics::palette::IndexedImage;
+
+	// In-tree PNG encoder. Rows are filtered with vectorised Sub, Up and
+	// Paeth filters, picking per row the one with the smallest sum of
+	// absolute values, then deflated in a single pass by libdeflate, which
+	// also provides the PCLMUL/ARMv8 accelerated CRC-32.
+	//
+	// Both overloads append the PNG to the end of output, growing it once
+	// to the worst case size and shrinking it back afterwards, so the
+	// caller can reuse a buffer or place a header in front of the image.
+
+	// Opaque 8 bit RGB, the alpha channel of screen captures is unused.
+	void write_png(const Frame&, std::vector<std::byte>& output, int compression_level);
+
+	// Palette image, rows are stored unfiltered as the PNG spec recommends.
+	void write_png(const IndexedImage&, std::vector<std::byte>& output, int compression_level);
+}
@@ -0,0 +1,26 @@
+#include "recording_frame_source.h"
+
+using namespace hotk::graphics::recording_frame_source;
+
+RecordingFrameSource::RecordingFrameSource(std::shared_ptr<FrameSource> source, const std::string& path)
+	: _source(std::move(source))
+	, _writer(path)
+	, _started_at(std::chrono::steady_clock::now())
+{
+}
+
+Frame RecordingFrameSource::next_frame()
+{
+	auto frame   = _source->next_frame();
+	auto elapsed = std::chrono::steady_clock::now() - _started_at;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_writer.append(frame, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+
+	return frame;
+}
+
+std::vector<Monitor> RecordingFrameSource::monitors()
+{
+	return _source->monitors();
+}
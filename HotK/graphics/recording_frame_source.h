@@ -0,0 +1,35 @@
+#pragma once
+
+#include "frame_source.h"
+#include "frame_corpus.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace hotk::graphics::recording_frame_source {
+	using hotk::graphics::frame_source::FrameSource;
+	using hotk::graphics::frame_source::Monitor;
+	using hotk::graphics::frame::Frame;
+	using hotk::graphics::frame_corpus::CorpusWriter;
+
+	// Passes frames through from another source and appends each one to a
+	// corpus file, to be replayed later by ReplayFrameSource. Monitor
+	// captures are cut out of a recorded whole frame, so the corpus only
+	// ever holds full desktops.
+	class RecordingFrameSource : public FrameSource {
+	private:
+		std::shared_ptr<FrameSource>          _source;
+		std::mutex                            _mutex;
+		CorpusWriter                          _writer;
+		std::chrono::steady_clock::time_point _started_at;
+
+	public:
+		RecordingFrameSource(std::shared_ptr<FrameSource> source, const std::string& path);
+
+		Frame next_frame() override;
+		std::vector<Monitor> monitors() override;
+	};
+}
@@ -0,0 +1,36 @@
+#include "replay_frame_source.h"
+#include "../errors/errors.h"
+
+using namespace hotk::graphics::replay_frame_source;
+
+using hotk::errors::ErrorCode;
+
+ReplayFrameSource::ReplayFrameSource(const std::string& path)
+	: _reader(path)
+	, _frame_number(0)
+{
+	if (_reader.frame_count() == 0) {
+		std::string message = "replay: " + path + " holds no frames";
+		throw ErrorCode(1, message);
+	}
+}
+
+std::size_t ReplayFrameSource::frame_count() const noexcept
+{
+	return _reader.frame_count();
+}
+
+int32_t ReplayFrameSource::width() const
+{
+	return _reader.entry(0).width;
+}
+
+int32_t ReplayFrameSource::height() const
+{
+	return _reader.entry(0).height;
+}
+
+Frame ReplayFrameSource::next_frame()
+{
+	return _reader.frame(_frame_number++ % _reader.frame_count());
+}
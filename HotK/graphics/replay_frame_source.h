@@ -0,0 +1,32 @@
+#pragma once
+
+#include "frame_source.h"
+#include "frame_corpus.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace hotk::graphics::replay_frame_source {
+	using hotk::graphics::frame_source::FrameSource;
+	using hotk::graphics::frame::Frame;
+	using hotk::graphics::frame_corpus::CorpusReader;
+
+	// Serves the frames of a recorded corpus in order, starting over after
+	// the last one. Frames point straight into the mapped file.
+	class ReplayFrameSource : public FrameSource {
+	private:
+		CorpusReader          _reader;
+		std::atomic<uint64_t> _frame_number;
+
+	public:
+		explicit ReplayFrameSource(const std::string& path);
+
+		std::size_t frame_count() const noexcept;
+		// Size of the first frame, recordings rarely change resolution.
+		int32_t width() const;
+		int32_t height() const;
+
+		Frame next_frame() override;
+	};
+}
@@ -16,44 +16,138 @@ using hotk::graphics::screen_capture::HDCPtr;
 using hotk::graphics::screen_capture::CompatibleDCPtr;
 using hotk::graphics::screen_capture::HBITMAPPtr;
 using hotk::graphics::screen_capture::ScreenCapture;
+using hotk::graphics::frame::Frame;
+using hotk::graphics::frame_source::Monitor;
 
 using hotk::winutils::errors::Win32Error;
 
+namespace {
+	struct Rect {
+		int32_t x;
+		int32_t y;
+		int32_t width;
+		int32_t height;
+	};
+
+	// The bounding box of every monitor, in desktop coordinates where the
+	// primary monitor's top left corner is the origin.
+	Rect get_virtual_screen()
+	{
+		Rect rect;
+
+		rect.x      = GetSystemMetrics(SM_XVIRTUALSCREEN);
+		rect.y      = GetSystemMetrics(SM_YVIRTUALSCREEN);
+		rect.width  = GetSystemMetrics(SM_CXVIRTUALSCREEN);
+		if (rect.width == 0)
+			throw Win32Error(GetLastError(), "capture screen: failed to get screen width");
+
+		rect.height = GetSystemMetrics(SM_CYVIRTUALSCREEN);
+		if (rect.height == 0)
+			throw Win32Error(GetLastError(), "capture screen: failed to get screen height");
+
+		return rect;
+	}
+
+	// Takes desktop coordinates.
+	std::unique_ptr<ScreenCapture> capture_desktop(const Rect& area)
+	{
+		// Create device contexts.
+		auto hdc = HDCPtr(GetDC(nullptr));
+		if (hdc.get() == nullptr)
+			throw Win32Error(GetLastError(), "capture screen: GetDC failed");
+
+		auto hDest = CompatibleDCPtr(CreateCompatibleDC(hdc.get()));
+		if (hDest.get() == nullptr)
+			throw Win32Error(GetLastError(), "capture screen: CreateCompatibleDC failed");
+
+		// Create the Bitmap.
+		auto hbitmap = HBITMAPPtr(CreateCompatibleBitmap(hdc.get(), area.width, area.height));
+		if (hbitmap.get() == nullptr)
+			throw Win32Error(GetLastError(), "capture screen: CreateCompatibleBitmap failed");
+
+		// Use the previously created device context with the bitmap.
+		auto result = SelectObject(hDest.get(), hbitmap.get());
+		if (result == NULL || result == HGDI_ERROR)
+			throw Win32Error(GetLastError(), "capture screen: SelectObject failed");
+
+		// Copy from the desktop device context to the bitmap device context
+		// call this once per 'frame'. The screen DC uses desktop coordinates,
+		// monitors left of or above the primary one start below zero.
+		auto bitblt_result = BitBlt(hDest.get(), 0, 0, area.width, area.height, hdc.get(), area.x, area.y, SRCCOPY);
+		if (bitblt_result == NULL)
+			throw Win32Error(GetLastError(), "capture screen: BitBlt failed");
+
+		return std::make_unique<ScreenCapture>(std::move(hdc), std::move(hbitmap));
+	}
+
+	BOOL CALLBACK add_monitor(HMONITOR hmonitor, HDC, LPRECT, LPARAM context)
+	{
+		auto*       monitors = reinterpret_cast<std::vector<Monitor>*>(context);
+		MONITORINFO info;
+
+		info.cbSize = sizeof(MONITORINFO);
+		if (GetMonitorInfo(hmonitor, &info) == 0)
+			return TRUE;
+
+		monitors->push_back(Monitor{
+			info.rcMonitor.left,
+			info.rcMonitor.top,
+			info.rcMonitor.right - info.rcMonitor.left,
+			info.rcMonitor.bottom - info.rcMonitor.top,
+			(info.dwFlags & MONITORINFOF_PRIMARY) != 0,
+		});
+
+		return TRUE;
+	}
+}
+
 std::unique_ptr<ScreenCapture> screen::capture_full_screen()
 {
-	// Create device contexts.
-	auto hdc = HDCPtr(GetDC(nullptr));
-	if (hdc.get() == nullptr)
-		throw Win32Error(GetLastError(), "capture full screen: GetDC failed");
-
-	auto hDest = CompatibleDCPtr(CreateCompatibleDC(hdc.get()));
-	if (hDest.get() == nullptr)
-		throw Win32Error(GetLastError(), "capture full screen: CreateCompatibleDC failed");
-
-	// Get screen dimensions.
-	int width = GetSystemMetrics(SM_CXVIRTUALSCREEN);
-	if (width == 0)
-		throw Win32Error(GetLastError(), "capture full screen: failed to get screen width");
-
-	int height = GetSystemMetrics(SM_CYVIRTUALSCREEN);
-	if (height == 0)
-		throw Win32Error(GetLastError(), "capture full screen: failed to get screen height");
-
-	// Create the Bitmap.
-	auto hbitmap = HBITMAPPtr(CreateCompatibleBitmap(hdc.get(), width, height));
-	if (hbitmap.get() == nullptr)
-		throw Win32Error(GetLastError(), "capture full screen: CreateCompatibleBitmap failed");
-
-	// Use the previously created device context with the bitmap.
-	auto result = SelectObject(hDest.get(), hbitmap.get());
-	if (result == NULL || result == HGDI_ERROR)
-		throw Win32Error(GetLastError(), "capture full screen: SelectObject failed");
-
-	// Copy from the desktop device context to the bitmap device context
-	// call this once per 'frame'.
-	auto bitblt_result = BitBlt(hDest.get(), 0, 0, width, height, hdc.get(), 0, 0, SRCCOPY);
-	if (bitblt_result == NULL)
-		throw Win32Error(GetLastError(), "capture full screen: BitBlt failed");
-
-	return std::make_unique<ScreenCapture>(std::move(hdc), std::move(hbitmap));
-}
\ No newline at end of file
+	return capture_desktop(get_virtual_screen());
+}
+
+std::unique_ptr<ScreenCapture> screen::capture_area(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+	auto desktop = get_virtual_screen();
+
+	return capture_desktop(Rect{ desktop.x + x, desktop.y + y, width, height });
+}
+
+std::vector<Monitor> screen::enumerate_monitors()
+{
+	std::vector<Monitor> monitors;
+
+	if (EnumDisplayMonitors(nullptr, nullptr, add_monitor, reinterpret_cast<LPARAM>(&monitors)) == 0)
+		throw Win32Error(GetLastError(), "enumerate monitors: EnumDisplayMonitors failed");
+
+	// Make them relative to the virtual screen, like full screen captures.
+	auto desktop = get_virtual_screen();
+
+	for (auto& monitor : monitors) {
+		monitor.x -= desktop.x;
+		monitor.y -= desktop.y;
+	}
+
+	return monitors;
+}
+
+Frame screen::ScreenFrameSource::next_frame()
+{
+	return capture_full_screen()->to_frame();
+}
+
+std::vector<Monitor> screen::ScreenFrameSource::monitors()
+{
+	return enumerate_monitors();
+}
+
+std::vector<Frame> screen::ScreenFrameSource::next_monitor_frames(const std::vector<Monitor>& monitors)
+{
+	std::vector<Frame> frames;
+
+	frames.reserve(monitors.size());
+	for (const auto& monitor : monitors)
+		frames.push_back(capture_area(monitor.x, monitor.y, monitor.width, monitor.height)->to_frame());
+
+	return frames;
+}
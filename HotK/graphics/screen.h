@@ -3,8 +3,10 @@
 #include "../winutils/deleters.h"
 #include "../winutils/errors.h"
 #include "screen_capture.h"
+#include "frame_source.h"
 #include "errors.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <cstddef>
@@ -12,6 +14,25 @@
 
 namespace hotk::graphics::screen {
 	using hotk::graphics::screen_capture::ScreenCapture;
+	using hotk::graphics::frame_source::FrameSource;
+	using hotk::graphics::frame_source::Monitor;
+	using hotk::graphics::frame::Frame;
 
 	std::unique_ptr<ScreenCapture> capture_full_screen();
+	// Captures part of the virtual screen, x and y are relative to its top
+	// left corner like Monitor.
+	std::unique_ptr<ScreenCapture> capture_area(int32_t x, int32_t y, int32_t width, int32_t height);
+
+	// Every attached monitor, the order EnumDisplayMonitors reports them.
+	std::vector<Monitor> enumerate_monitors();
+
+	// Frame source backed by the real desktop.
+	class ScreenFrameSource : public FrameSource {
+	public:
+		Frame next_frame() override;
+		std::vector<Monitor> monitors() override;
+		// Grabs every monitor on its own, which skips the dead space
+		// between monitors of different sizes.
+		std::vector<Frame> next_monitor_frames(const std::vector<Monitor>&) override;
+	};
 }
\ No newline at end of file
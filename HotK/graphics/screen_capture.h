@@ -2,6 +2,7 @@
 
 #include "../winutils/deleters.h"
 #include "../winutils/errors.h"
+#include "frame.h"
 
 #include <Windows.h>
 #include <vector>
@@ -11,6 +12,7 @@ namespace hotk::graphics::screen_capture {
 	using hotk::winutils::deleters::CompatibleDCDeleter;
 	using hotk::winutils::deleters::HBitmapDeleter;
 	using hotk::winutils::deleters::HDCDeleter;
+	using hotk::graphics::frame::Frame;
 
 	using HDCPtr = std::unique_ptr<HDC__, HDCDeleter>;
 	using CompatibleDCPtr = std::unique_ptr<HDC__, CompatibleDCDeleter>;
@@ -27,12 +29,10 @@ namespace hotk::graphics::screen_capture {
 		void fill_bitmap_info(const HBITMAP);
 		void fill_bitmap_file_header(const BITMAPINFO&);
 
-		std::vector<std::byte*> get_bitmap_rows(std::vector<std::byte>& bmp, LONG height, LONG width) const;
-		std::vector<std::byte> perform_png_conversion(BITMAPINFOHEADER& info_header, std::vector<std::byte*>& rows) const;
-
 	public:
 		ScreenCapture(HDCPtr, HBITMAPPtr);
 
+		Frame to_frame();
 		std::vector<std::byte> to_bmp();
 		std::vector<std::byte> to_png();
 	};
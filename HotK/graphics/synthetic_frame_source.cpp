@@ -0,0 +1,128 @@
+#include "synthetic_frame_source.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace hotk::graphics::synthetic_frame_source;
+
+namespace {
+	const int32_t glyph_width   = 8;
+	const int32_t glyph_height  = 14;
+	const int32_t window_width  = 640;
+	const int32_t window_height = 420;
+
+	void put_pixel(std::byte* pixel, uint8_t b, uint8_t g, uint8_t r)
+	{
+		pixel[0] = static_cast<std::byte>(b);
+		pixel[1] = static_cast<std::byte>(g);
+		pixel[2] = static_cast<std::byte>(r);
+		pixel[3] = static_cast<std::byte>(0xFF);
+	}
+
+	// Small xorshift so the pseudo text is identical on every run.
+	uint32_t next_random(uint32_t& state)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+}
+
+SyntheticFrameSource::SyntheticFrameSource(int32_t width, int32_t height, int32_t monitor_count)
+	: _width(width)
+	, _height(height)
+	, _monitor_count(monitor_count)
+	, _frame_number(0)
+{
+	assert(width > 0 && height > 0);
+	assert(monitor_count > 0 && monitor_count <= width);
+
+	draw_background();
+}
+
+void SyntheticFrameSource::draw_background()
+{
+	const std::size_t stride = static_cast<std::size_t>(_width) * 4;
+	uint32_t          seed   = 0x12345678;
+
+	_background.resize(stride * _height);
+
+	for (int32_t y = 0; y < _height; y++) {
+		auto* row = _background.data() + stride * y;
+
+		for (int32_t x = 0; x < _width; x++)
+			put_pixel(row + x * 4, 0x30, 0x30, 0x30);
+	}
+
+	// Lines of "text": glyph cells that are either blank or filled with a
+	// sparse random pattern in one of a handful of syntax colours.
+	const uint8_t palette[][3] = {
+		{ 0xD4, 0xD4, 0xD4 },
+		{ 0xD6, 0x9C, 0x56 },
+		{ 0x78, 0xC3, 0xCE },
+		{ 0x6A, 0x99, 0x55 },
+	};
+
+	for (int32_t line = 0; line + glyph_height <= _height; line += glyph_height + 4) {
+		int32_t line_length = static_cast<int32_t>(next_random(seed) % (_width / glyph_width));
+
+		for (int32_t column = 0; column < line_length; column++) {
+			if (next_random(seed) % 6 == 0)
+				continue;
+
+			const auto& colour = palette[next_random(seed) % 4];
+
+			for (int32_t gy = 0; gy < glyph_height; gy++) {
+				auto* row = _background.data() + stride * (line + gy);
+
+				for (int32_t gx = 1; gx < glyph_width - 1; gx++) {
+					if (next_random(seed) % 3 == 0)
+						put_pixel(row + (column * glyph_width + gx) * 4, colour[0], colour[1], colour[2]);
+				}
+			}
+		}
+	}
+}
+
+Frame SyntheticFrameSource::next_frame()
+{
+	const std::size_t stride       = static_cast<std::size_t>(_width) * 4;
+	const uint64_t    frame_number = _frame_number++;
+	auto              pixels       = _background;
+
+	// Slide a window across the desktop to simulate activity.
+	const int32_t w      = std::min(window_width, _width);
+	const int32_t h      = std::min(window_height, _height);
+	const int32_t left   = static_cast<int32_t>((frame_number * 16) % (_width - w + 1));
+	const int32_t top    = static_cast<int32_t>((frame_number * 8) % (_height - h + 1));
+
+	for (int32_t y = top; y < top + h; y++) {
+		auto* row = pixels.data() + stride * y;
+
+		for (int32_t x = left; x < left + w; x++) {
+			bool title_bar = y >= top + h - 24;
+
+			if (title_bar)
+				put_pixel(row + x * 4, 0xB0, 0x60, 0x20);
+			else
+				put_pixel(row + x * 4, 0xF0, 0xF0, 0xF0);
+		}
+	}
+
+	return Frame(_width, _height, std::move(pixels));
+}
+
+std::vector<Monitor> SyntheticFrameSource::monitors()
+{
+	std::vector<Monitor> monitors;
+
+	for (int32_t i = 0; i < _monitor_count; i++) {
+		int32_t left  = _width * i / _monitor_count;
+		int32_t right = _width * (i + 1) / _monitor_count;
+
+		monitors.push_back(Monitor{ left, 0, right - left, _height, i == 0 });
+	}
+
+	return monitors;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "frame_source.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::graphics::synthetic_frame_source {
+	using hotk::graphics::frame_source::FrameSource;
+	using hotk::graphics::frame_source::Monitor;
+	using hotk::graphics::frame::Frame;
+
+	// Generates desktop-like frames without touching the screen: a flat
+	// background covered with rows of pseudo text plus a window that moves
+	// a little on every frame. Consecutive frames are mostly identical,
+	// just like a real desktop, which keeps encoder numbers meaningful.
+	//
+	// The frame can be split into several monitors of equal width, side by
+	// side, to exercise per monitor captures.
+	class SyntheticFrameSource : public FrameSource {
+	private:
+		int32_t                _width;
+		int32_t                _height;
+		int32_t                _monitor_count;
+		std::vector<std::byte> _background;
+		std::atomic<uint64_t>  _frame_number;
+
+		void draw_background();
+
+	public:
+		SyntheticFrameSource(int32_t width, int32_t height, int32_t monitor_count = 1);
+
+		Frame next_frame() override;
+		std::vector<Monitor> monitors() override;
+	};
+}
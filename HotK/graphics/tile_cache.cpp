@@ -0,0 +1,47 @@
+#include "tile_cache.h"
+
+#include <cassert>
+
+using namespace hotk::graphics::tile_cache;
+
+TileCache::TileCache(std::size_t capacity)
+	: _capacity(capacity)
+{
+	assert(capacity > 0);
+
+	_entries.reserve(capacity);
+}
+
+std::size_t TileCache::capacity() const noexcept
+{
+	return _capacity;
+}
+
+bool TileCache::touch(uint64_t hash)
+{
+	auto entry = _entries.find(hash);
+	if (entry == _entries.end())
+		return false;
+
+	_lru.splice(_lru.begin(), _lru, entry->second);
+	return true;
+}
+
+void TileCache::insert(uint64_t hash)
+{
+	assert(_entries.count(hash) == 0);
+
+	if (_entries.size() >= _capacity) {
+		_entries.erase(_lru.back());
+		_lru.pop_back();
+	}
+
+	_lru.push_front(hash);
+	_entries.emplace(hash, _lru.begin());
+}
+
+void TileCache::clear()
+{
+	_lru.clear();
+	_entries.clear();
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+namespace hotk::graphics::tile_cache {
+	// LRU of the content hashes of tiles the server already holds. The
+	// server keeps a cache of the same capacity and applies the same
+	// touch/insert sequence while decoding, so both sides always evict the
+	// same entries and a hash found here is guaranteed to be found there.
+	class TileCache {
+	private:
+		std::size_t                                                 _capacity;
+		std::list<uint64_t>                                         _lru;
+		std::unordered_map< uint64_t, std::list<uint64_t>::iterator > _entries;
+
+	public:
+		explicit TileCache(std::size_t capacity);
+
+		std::size_t capacity() const noexcept;
+
+		// Marks the hash as most recently used. Returns false when it is
+		// not cached.
+		bool touch(uint64_t hash);
+		// Adds a new hash, evicting the least recently used one when full.
+		void insert(uint64_t hash);
+		void clear();
+	};
+}
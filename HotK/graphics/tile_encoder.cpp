@@ -0,0 +1,149 @@
+#include "tile_encoder.h"
+#include "png_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tile_encoder = hotk::graphics::tile_encoder;
+
+using hotk::graphics::frame::Frame;
+using hotk::graphics::tile_cache::TileCache;
+using hotk::graphics::png_encoder::encode_png;
+
+namespace {
+	enum class TileKind : uint8_t {
+		Cached = 0,
+		New,
+	};
+
+	struct TileRect {
+		int32_t x;
+		int32_t y;
+		int32_t width;
+		int32_t height;
+	};
+
+	template<typename T>
+	void append(std::vector<std::byte>& output, T value)
+	{
+		const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+
+		output.insert(output.end(), bytes, bytes + sizeof(T));
+	}
+
+	uint64_t mix(uint64_t hash, uint64_t word)
+	{
+		hash ^= word;
+		hash *= 0xFF51AFD7ED558CCDull;
+		return hash ^ (hash >> 32);
+	}
+
+	uint64_t hash_tile(const Frame& frame, const TileRect& tile)
+	{
+		const std::size_t row_size = static_cast<std::size_t>(tile.width) * 4;
+		uint64_t          hash     = mix(0x9E3779B97F4A7C15ull,
+			(static_cast<uint64_t>(tile.width) << 32) | static_cast<uint32_t>(tile.height));
+
+		for (int32_t y = 0; y < tile.height; y++) {
+			const std::byte* row    = frame.row(tile.y + y) + static_cast<std::size_t>(tile.x) * 4;
+			std::size_t      offset = 0;
+
+			for (; offset + 8 <= row_size; offset += 8) {
+				uint64_t word;
+
+				std::memcpy(&word, row + offset, 8);
+				hash = mix(hash, word);
+			}
+
+			// Rows are whole pixels so at most one 4 byte pixel is left.
+			if (offset < row_size) {
+				uint32_t word;
+
+				std::memcpy(&word, row + offset, 4);
+				hash = mix(hash, word);
+			}
+		}
+
+		return hash;
+	}
+
+	Frame build_atlas(const Frame& frame, const std::vector<TileRect>& tiles)
+	{
+		const int32_t     height = static_cast<int32_t>(tiles.size()) * tile_encoder::tile_size;
+		const std::size_t stride = static_cast<std::size_t>(tile_encoder::tile_size) * 4;
+
+		std::vector<std::byte> pixels(stride * height);
+
+		for (std::size_t i = 0; i < tiles.size(); i++) {
+			const auto& tile = tiles[i];
+
+			for (int32_t y = 0; y < tile.height; y++) {
+				// Frames are stored bottom-up, so the atlas row counting from
+				// the top lives at height - 1 - row.
+				int32_t atlas_row = static_cast<int32_t>(i) * tile_encoder::tile_size + y;
+
+				std::memcpy(
+					pixels.data() + static_cast<std::size_t>(height - 1 - atlas_row) * stride,
+					frame.row(tile.y + y) + static_cast<std::size_t>(tile.x) * 4,
+					static_cast<std::size_t>(tile.width) * 4);
+			}
+		}
+
+		return Frame(tile_encoder::tile_size, height, std::move(pixels));
+	}
+}
+
+std::vector<std::byte> tile_encoder::encode_tiles(const Frame& frame, TileCache& cache, uint32_t sequence)
+{
+	const int32_t columns = (frame.width() + tile_size - 1) / tile_size;
+	const int32_t rows    = (frame.height() + tile_size - 1) / tile_size;
+	const auto    count   = static_cast<uint32_t>(columns * rows);
+
+	std::vector<std::byte> output;
+	std::vector<TileRect>  new_tiles;
+
+	output.reserve(26 + count * (sizeof(uint8_t) + sizeof(uint64_t)));
+	append<uint32_t>(output, sequence);
+	append<uint32_t>(output, static_cast<uint32_t>(cache.capacity()));
+	append<int32_t>(output, frame.width());
+	append<int32_t>(output, frame.height());
+	append<uint16_t>(output, static_cast<uint16_t>(tile_size));
+	append<uint32_t>(output, count);
+
+	for (int32_t row = 0; row < rows; row++) {
+		for (int32_t column = 0; column < columns; column++) {
+			TileRect tile = {
+				column * tile_size,
+				row * tile_size,
+				std::min(tile_size, frame.width() - column * tile_size),
+				std::min(tile_size, frame.height() - row * tile_size),
+			};
+
+			uint64_t hash = hash_tile(frame, tile);
+			auto     kind = TileKind::Cached;
+
+			// Repeated tiles within the same frame hit the entry inserted
+			// by their first occurrence.
+			if (!cache.touch(hash)) {
+				cache.insert(hash);
+				new_tiles.push_back(tile);
+				kind = TileKind::New;
+			}
+
+			append<uint8_t>(output, static_cast<uint8_t>(kind));
+			append<uint64_t>(output, hash);
+		}
+	}
+
+	if (new_tiles.empty()) {
+		append<uint64_t>(output, 0);
+		return output;
+	}
+
+	auto atlas = encode_png(build_atlas(frame, new_tiles));
+
+	append<uint64_t>(output, atlas.size());
+	output.insert(output.end(), atlas.begin(), atlas.end());
+
+	return output;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "frame.h"
+#include "tile_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::graphics::tile_encoder {
+	using hotk::graphics::frame::Frame;
+	using hotk::graphics::tile_cache::TileCache;
+
+	const int32_t tile_size = 64;
+
+	// Splits the frame into tiles and only encodes the ones whose content
+	// the server does not hold yet, the rest are sent as references to its
+	// cache. Integers are in host byte order like the message header:
+	//
+	//   uint32 sequence          0 after a cache reset, +1 per message
+	//   uint32 cache_capacity    tiles the server must keep, LRU evicted
+	//   int32  width, height
+	//   uint16 tile_size
+	//   uint32 tile_count        row-major, starting at the top left
+	//   tile_count x
+	//     uint8  kind            0 cached, 1 new
+	//     uint64 hash
+	//   uint64 atlas_size
+	//   atlas                    PNG tile_size wide holding every new tile
+	//                            stacked top to bottom in order, edge tiles
+	//                            padded with zeros on the right and bottom
+	//
+	// The server must apply the references and inserts to its cache in
+	// tile order so both caches keep evicting the same entries.
+	std::vector<std::byte> encode_tiles(const Frame&, TileCache&, uint32_t sequence);
+}
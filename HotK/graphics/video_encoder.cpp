@@ -0,0 +1,192 @@
+#include "video_encoder.h"
+#include "../errors/errors.h"
+
+#include <cstring>
+#include <string>
+
+#include <wels/codec_api.h>
+
+namespace video_encoder = hotk::graphics::video_encoder;
+
+using video_encoder::VideoEncoder;
+using video_encoder::VideoFrameKind;
+using hotk::errors::ErrorCode;
+using hotk::graphics::frame::Frame;
+using hotk::graphics::i420::bgra_to_i420;
+
+namespace {
+	const std::size_t header_size = 16;
+
+	void check(int result, const char* what)
+	{
+		if (result != cmResultSuccess) {
+			std::string message = std::string("video encoder: ") + what + " failed with " + std::to_string(result);
+			throw ErrorCode(1, message);
+		}
+	}
+
+	template <typename T>
+	void put(std::byte* target, T value)
+	{
+		std::memcpy(target, &value, sizeof(T));
+	}
+}
+
+void video_encoder::EncoderDeleter::operator()(ISVCEncoder* encoder)
+{
+	encoder->Uninitialize();
+	WelsDestroySVCEncoder(encoder);
+}
+
+VideoEncoder::VideoEncoder(const VideoOptions& options)
+	: _options(options)
+	, _width(0)
+	, _height(0)
+	, _sequence(0)
+	, _keyframe_requested(true)
+	, _started_at(clock::now())
+{
+}
+
+void VideoEncoder::initialize(int32_t width, int32_t height)
+{
+	_encoder.reset();
+
+	ISVCEncoder* encoder = nullptr;
+	if (WelsCreateSVCEncoder(&encoder) != 0 || encoder == nullptr)
+		throw ErrorCode(1, "video encoder: WelsCreateSVCEncoder failed");
+
+	// Owns it from here on, even if initialising fails.
+	std::unique_ptr<ISVCEncoder, EncoderDeleter> owner(encoder);
+	SEncParamExt                                 params;
+
+	check(encoder->GetDefaultParams(&params), "GetDefaultParams");
+
+	// Screen content mode turns on the tools meant for text and flat
+	// areas, and a single thread and slice keep the latency to one frame.
+	params.iUsageType                 = SCREEN_CONTENT_REAL_TIME;
+	params.iPicWidth                  = _picture.width;
+	params.iPicHeight                 = _picture.height;
+	params.iRCMode                    = RC_BITRATE_MODE;
+	params.iTargetBitrate             = _options.bitrate_kbps * 1000;
+	params.fMaxFrameRate              = static_cast<float>(_options.frame_rate);
+	params.bEnableFrameSkip           = true;
+	params.uiIntraPeriod              = _options.keyframe_interval;
+	params.iMultipleThreadIdc         = 1;
+	params.iEntropyCodingModeFlag     = 0;
+	params.bEnableDenoise             = false;
+	params.bEnableSceneChangeDetect   = true;
+	params.bEnableBackgroundDetection = true;
+	params.bEnableAdaptiveQuant       = false;
+	params.iSpatialLayerNum           = 1;
+	params.iTemporalLayerNum          = 1;
+
+	auto& layer = params.sSpatialLayers[0];
+
+	layer.iVideoWidth                = _picture.width;
+	layer.iVideoHeight               = _picture.height;
+	layer.fFrameRate                 = params.fMaxFrameRate;
+	layer.iSpatialBitrate            = params.iTargetBitrate;
+	layer.sSliceArgument.uiSliceMode = SM_SINGLE_SLICE;
+
+	check(encoder->InitializeExt(&params), "InitializeExt");
+
+	int format = videoFormatI420;
+	check(encoder->SetOption(ENCODER_OPTION_DATAFORMAT, &format), "SetOption(DATAFORMAT)");
+
+	_encoder = std::move(owner);
+	_width   = width;
+	_height  = height;
+}
+
+void VideoEncoder::set_rate(int32_t frame_rate, int32_t bitrate_kbps)
+{
+	if (frame_rate == _options.frame_rate && bitrate_kbps == _options.bitrate_kbps)
+		return;
+
+	_options.frame_rate   = frame_rate;
+	_options.bitrate_kbps = bitrate_kbps;
+
+	// A fresh encoder starts with a keyframe on its own.
+	_encoder.reset();
+}
+
+void VideoEncoder::request_keyframe()
+{
+	_keyframe_requested = true;
+}
+
+std::vector<std::byte> VideoEncoder::encode(const Frame& frame)
+{
+	bgra_to_i420(frame, _picture);
+
+	if (!_encoder || frame.width() != _width || frame.height() != _height)
+		initialize(frame.width(), frame.height());
+	else if (_keyframe_requested)
+		check(_encoder->ForceIntraFrame(true), "ForceIntraFrame");
+
+	SSourcePicture picture;
+	SFrameBSInfo   info;
+
+	std::memset(&picture, 0, sizeof(picture));
+	std::memset(&info, 0, sizeof(info));
+
+	picture.iColorFormat = videoFormatI420;
+	picture.iPicWidth    = _picture.width;
+	picture.iPicHeight   = _picture.height;
+	picture.iStride[0]   = _picture.width;
+	picture.iStride[1]   = static_cast<int>(_picture.chroma_width());
+	picture.iStride[2]   = static_cast<int>(_picture.chroma_width());
+	picture.pData[0]     = _picture.y.data();
+	picture.pData[1]     = _picture.u.data();
+	picture.pData[2]     = _picture.v.data();
+	picture.uiTimeStamp  = std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - _started_at).count();
+
+	check(_encoder->EncodeFrame(&picture, &info), "EncodeFrame");
+
+	VideoFrameKind kind;
+
+	switch (info.eFrameType) {
+	case videoFrameTypeIDR:
+	case videoFrameTypeI:
+		kind = VideoFrameKind::Key;
+		break;
+
+	case videoFrameTypeSkip:
+		kind = VideoFrameKind::Skipped;
+		break;
+
+	default:
+		kind = VideoFrameKind::Delta;
+	}
+
+	// Asked again on the next frame should the rate control skip this one.
+	if (kind == VideoFrameKind::Key)
+		_keyframe_requested = false;
+
+	std::vector<std::byte> output(header_size);
+
+	put<uint32_t>(output.data(), _sequence++);
+	put<uint8_t>(output.data() + 4, static_cast<uint8_t>(kind));
+	put<int32_t>(output.data() + 8, frame.width());
+	put<int32_t>(output.data() + 12, frame.height());
+
+	if (kind == VideoFrameKind::Skipped)
+		return output;
+
+	// Every layer holds its NAL units back to back, start codes included.
+	output.reserve(header_size + info.iFrameSizeInBytes);
+
+	for (int i = 0; i < info.iLayerNum; i++) {
+		const auto& layer = info.sLayerInfo[i];
+		std::size_t size  = 0;
+
+		for (int nal = 0; nal < layer.iNalCount; nal++)
+			size += layer.pNalLengthInByte[nal];
+
+		auto* bytes = reinterpret_cast<const std::byte*>(layer.pBsBuf);
+		output.insert(output.end(), bytes, bytes + size);
+	}
+
+	return output;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "frame.h"
+#include "i420.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class ISVCEncoder;
+
+namespace hotk::graphics::video_encoder {
+	using hotk::graphics::frame::Frame;
+	using hotk::graphics::i420::I420Image;
+
+	// Consecutive captures as an H.264 stream, encoded by openh264 in its
+	// screen content real time mode. Integers are in host byte order like
+	// the message header:
+	//
+	//   uint32 sequence          0 on the first packet, +1 per packet
+	//   uint8  kind              VideoFrameKind
+	//   uint8  reserved[3]
+	//   int32  width, height     of the capture, the coded picture is
+	//                            rounded up to even
+	//   Annex B NAL units        nothing for skipped frames
+	//
+	// Every packet but a skipped one must be decoded, in order. Keyframes
+	// start the stream, follow size and rate changes, come every
+	// keyframe_interval frames and whenever the server asks for one.
+	enum class VideoFrameKind : uint8_t {
+		Key = 0,
+		Delta,
+		// Dropped by the rate control to stay within the bitrate.
+		Skipped,
+	};
+
+	struct VideoOptions {
+		int32_t  frame_rate        = 15;
+		int32_t  bitrate_kbps      = 1500;
+		uint32_t keyframe_interval = 300;
+	};
+
+	struct EncoderDeleter {
+		void operator()(ISVCEncoder*);
+	};
+
+	class VideoEncoder {
+	private:
+		using clock = std::chrono::steady_clock;
+
+		VideoOptions                                 _options;
+		std::unique_ptr<ISVCEncoder, EncoderDeleter> _encoder;
+		I420Image                                    _picture;
+		int32_t                                      _width;
+		int32_t                                      _height;
+		uint32_t                                     _sequence;
+		bool                                         _keyframe_requested;
+		clock::time_point                            _started_at;
+
+		void initialize(int32_t width, int32_t height);
+
+	public:
+		explicit VideoEncoder(const VideoOptions& = VideoOptions());
+
+		// Restarts the stream with a keyframe when they differ from the
+		// current ones.
+		void set_rate(int32_t frame_rate, int32_t bitrate_kbps);
+		void request_keyframe();
+		std::vector<std::byte> encode(const Frame&);
+	};
+}
@@ -0,0 +1,83 @@
+#include "capture_coalescer.h"
+
+namespace handlers = hotk::handlers;
+
+using handlers::CaptureCoalescer;
+using handlers::CaptureKey;
+using handlers::EncodedCapture;
+
+CaptureCoalescer::CaptureCoalescer(Duration freshness)
+	: _freshness(freshness)
+{
+}
+
+void CaptureCoalescer::set_freshness(Duration freshness)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_freshness = freshness;
+}
+
+void CaptureCoalescer::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_entries.clear();
+}
+
+bool CaptureCoalescer::is_fresh(const Entry& entry, clock::time_point now) const
+{
+	return !entry.done || now - entry.started_at <= _freshness;
+}
+
+EncodedCapture CaptureCoalescer::get(const CaptureKey& key, const Produce& produce)
+{
+	std::promise<EncodedCapture>       promise;
+	std::shared_future<EncodedCapture> own = promise.get_future().share();
+	std::shared_future<EncodedCapture> result;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto                        now = clock::now();
+
+		// Only a handful of keys are ever in use, dropping stale entries
+		// here keeps their buffers from outliving the window.
+		for (auto entry = _entries.begin(); entry != _entries.end();) {
+			if (is_fresh(entry->second, now))
+				++entry;
+			else
+				entry = _entries.erase(entry);
+		}
+
+		auto entry = _entries.find(key);
+		if (entry != _entries.end())
+			result = entry->second.result;
+		else
+			_entries[key] = Entry{ now, own, false };
+	}
+
+	if (result.valid())
+		return result.get();
+
+	try {
+		promise.set_value(produce());
+	}
+	catch (...) {
+		promise.set_exception(std::current_exception());
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_entries.erase(key);
+		throw;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto                        entry = _entries.find(key);
+
+		// From now on the window decides how long it gets shared.
+		if (entry != _entries.end())
+			entry->second.done = true;
+	}
+
+	return own.get();
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace hotk::handlers {
+	// An encoded capture, shared by every reply that can use it. Per
+	// monitor captures hold the whole reply and the largest width and
+	// height among the monitors.
+	struct EncodedCapture {
+		int32_t                                       width;
+		int32_t                                       height;
+		std::shared_ptr<const std::vector<std::byte>> data;
+	};
+
+	// Everything that makes two encoded captures differ.
+	struct CaptureKey {
+		uint8_t codec;
+		uint8_t quality;
+		uint8_t subsampling;
+		uint8_t flags;
+		bool    detect_palette;
+		uint8_t monitor;
+
+		bool operator<(const CaptureKey& other) const noexcept {
+			return std::tie(codec, quality, subsampling, flags, detect_palette, monitor)
+				< std::tie(other.codec, other.quality, other.subsampling, other.flags, other.detect_palette, other.monitor);
+		}
+	};
+
+	// Lets equivalent capture requests share one capture and encode. A
+	// request joins the capture of an earlier one with the same key while
+	// that one is still running, on any connection, or when it started no
+	// longer than the freshness window ago. Otherwise it runs its own.
+	class CaptureCoalescer {
+	public:
+		using Duration = std::chrono::steady_clock::duration;
+		using Produce  = std::function<EncodedCapture()>;
+
+	private:
+		using clock = std::chrono::steady_clock;
+
+		struct Entry {
+			clock::time_point                  started_at;
+			std::shared_future<EncodedCapture> result;
+			bool                               done;
+		};
+
+		std::mutex                  _mutex;
+		Duration                    _freshness;
+		std::map<CaptureKey, Entry> _entries;
+
+		bool is_fresh(const Entry&, clock::time_point now) const;
+
+	public:
+		explicit CaptureCoalescer(Duration freshness);
+
+		void set_freshness(Duration);
+		// Forgets every capture, e.g. when the frame source changes.
+		void clear();
+
+		// Returns the shared capture for the key, running produce on the
+		// calling thread when there is none. Exceptions from produce reach
+		// every request that joined it.
+		EncodedCapture get(const CaptureKey&, const Produce& produce);
+	};
+}
@@ -1,4 +1,19 @@
 #include "handlers.h"
+#include "capture_coalescer.h"
+#include "workers.h"
+#include "../errors/errors.h"
+#include "../graphics/png_encoder.h"
+#include "../graphics/tile_encoder.h"
+#include "../graphics/jpeg_encoder.h"
+#include "../graphics/downscale.h"
+#include "../net/messages/capture_options.h"
+#include "../net/messages/hello.h"
+#include "../net/messages/video_request.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <string>
 
 namespace handlers = hotk::handlers;
 namespace screen   = hotk::graphics::screen;
@@ -6,17 +21,126 @@ namespace screen   = hotk::graphics::screen;
 using handlers::TcpClient;
 using handlers::MessageType;
 using handlers::Win32Error;
+using handlers::FrameSource;
+using handlers::CaptureCoalescer;
+using handlers::CaptureKey;
+using handlers::EncodedCapture;
+
+using hotk::errors::ErrorCode;
+
+using hotk::graphics::frame::Frame;
+using hotk::graphics::frame_source::Monitor;
+using hotk::graphics::downscale::downscale;
+using hotk::graphics::png_encoder::encode_png;
+using hotk::graphics::png_encoder::PngOptions;
+using hotk::graphics::tile_encoder::encode_tiles;
+using hotk::graphics::jpeg_encoder::encode_jpeg;
+using hotk::graphics::jpeg_encoder::JpegOptions;
+using hotk::graphics::jpeg_encoder::ChromaSubsampling;
+using hotk::net::messages::CaptureOptions;
+using hotk::net::messages::ImageCodec;
+using hotk::net::messages::parse_capture_options;
+using hotk::net::messages::Hello;
+using hotk::net::messages::HeaderFormat;
+using hotk::net::messages::serialize_hello;
+using hotk::net::messages::parse_hello;
+using hotk::net::messages::negotiate;
+using hotk::net::messages::parse_video_request;
+
+namespace capture_flags     = hotk::net::messages::capture_flags;
+namespace monitor_flags     = hotk::net::messages::monitor_flags;
+namespace video_flags       = hotk::net::messages::video_flags;
+namespace hello_features    = hotk::net::messages::hello_features;
+namespace hello_compression = hotk::net::messages::hello_compression;
+
+namespace {
+	// Longer side of progressive previews.
+	const int32_t preview_max_side = 480;
+	const uint8_t preview_quality  = 50;
+
+	std::shared_ptr<FrameSource> current_frame_source = std::make_shared<screen::ScreenFrameSource>();
+	CaptureCoalescer             capture_coalescer(handlers::default_capture_freshness);
+
+	template <typename T>
+	void append(std::vector<std::byte>& output, T value)
+	{
+		auto* bytes = reinterpret_cast<const std::byte*>(&value);
+		output.insert(output.end(), bytes, bytes + sizeof(T));
+	}
+
+	void append_monitor_layout(std::vector<std::byte>& output, const std::vector<Monitor>& monitors)
+	{
+		append<uint32_t>(output, static_cast<uint32_t>(monitors.size()));
+
+		for (const auto& monitor : monitors) {
+			append<int32_t>(output, monitor.x);
+			append<int32_t>(output, monitor.y);
+			append<int32_t>(output, monitor.width);
+			append<int32_t>(output, monitor.height);
+			append<uint32_t>(output, monitor.primary ? monitor_flags::primary : 0);
+		}
+	}
+
+	// Monitor 0 is the whole desktop, the rest count from 1 in layout order.
+	Frame grab_frame(uint8_t monitor)
+	{
+		auto source = std::atomic_load(&current_frame_source);
+
+		if (monitor == 0)
+			return source->next_frame();
+
+		auto monitors = source->monitors();
+
+		if (monitor > monitors.size()) {
+			std::string message = "capture: no monitor " + std::to_string(monitor)
+				+ ", there are " + std::to_string(monitors.size());
+			throw ErrorCode(1, message);
+		}
+
+		return std::move(source->next_monitor_frames({ monitors[monitor - 1] }).front());
+	}
+}
 
+void handlers::set_frame_source(std::shared_ptr<FrameSource> source)
+{
+	std::atomic_store(&current_frame_source, std::move(source));
+	capture_coalescer.clear();
+}
+
+void handlers::set_capture_freshness(std::chrono::steady_clock::duration freshness)
+{
+	capture_coalescer.set_freshness(freshness);
+}
 
-void handlers::process_message(TcpClient& tcp_client, const MessageType msg_type, std::vector<std::byte>&&)
+void handlers::process_message(TcpClient& tcp_client, const MessageType msg_type, std::vector<std::byte>&& data)
 {
 	switch (msg_type) {
+	case MessageType::Hello:
+		hotk::handlers::receive_hello(tcp_client, data);
+		break;
+
 	case MessageType::MachineInfo:
 		hotk::handlers::get_machine_info(tcp_client);
 		break;
 
+	case MessageType::MonitorLayout:
+		hotk::handlers::get_monitor_layout(tcp_client);
+		break;
+
 	case MessageType::ScreenCapture:
-		hotk::handlers::capture_screen(tcp_client);
+		hotk::handlers::capture_screen(tcp_client, data);
+		break;
+
+	case MessageType::ScreenCaptureTiles:
+		hotk::handlers::capture_screen_tiles(tcp_client, data);
+		break;
+
+	case MessageType::ScreenCaptureStream:
+		hotk::handlers::capture_screen_stream(tcp_client, data);
+		break;
+
+	case MessageType::VideoFrame:
+		hotk::handlers::capture_video(tcp_client, data);
 		break;
 
 	case MessageType::ServerShutdown:
@@ -29,6 +153,30 @@ void handlers::process_message(TcpClient& tcp_client, const MessageType msg_type
 	}
 }
 
+void handlers::send_hello(TcpClient& tcp_client)
+{
+	tcp_client.write(MessageType::Hello, serialize_hello(local_hello()));
+}
+
+void handlers::receive_hello(TcpClient& tcp_client, const std::vector<std::byte>& data)
+{
+	auto& session = get_session(tcp_client);
+	auto  remote  = parse_hello(data);
+
+	session.negotiated = negotiate(local_hello(), remote);
+
+	// The server promised nothing is sent after its Hello in the old
+	// format, and we only queue replies from here on.
+	tcp_client.set_header_format(session.negotiated.preferred_header_format);
+
+	// Servers that count on one reply per request get every screenshot.
+	if (!session.negotiated.has_feature(hello_features::dropped_replies))
+		tcp_client.set_queue_policy(MessageType::ScreenCapture, TcpClient::QueuePolicy::Append);
+
+	std::cout << "Negotiated protocol version " << session.negotiated.version
+		<< ", header format " << static_cast<uint16_t>(session.negotiated.preferred_header_format) << "\n";
+}
+
 std::vector<std::byte> get_computer_name()
 {
 	std::vector<std::byte> fqdn;
@@ -67,13 +215,295 @@ void handlers::get_machine_info(TcpClient& tcp_client)
 	tcp_client.write(MessageType::MachineInfo, std::move(machine_name));
 }
 
-void handlers::capture_screen(TcpClient& tcp_client)
+void handlers::get_monitor_layout(TcpClient& tcp_client)
+{
+	std::vector<std::byte> layout;
+
+	std::cout << "Getting monitor layout...\n";
+	append_monitor_layout(layout, std::atomic_load(&current_frame_source)->monitors());
+
+	tcp_client.write(MessageType::MonitorLayout, std::move(layout));
+}
+
+// Settles what the reply will actually contain, so that requests which
+// only differ in what the session cannot honour still share a capture.
+CaptureKey get_capture_key(const CaptureOptions& options, const Hello& negotiated)
+{
+	auto codec = options.codec;
+
+	// Servers newer than us may ask for codecs we do not know, or for ones
+	// the handshake ruled out. PNG is always understood and self describing.
+	if (!negotiated.supports(codec)) {
+		std::cout << "Unsupported codec requested: " << static_cast<uint16_t>(codec) << ", sending png\n";
+		codec = ImageCodec::Png;
+	}
+
+	return CaptureKey{
+		static_cast<uint8_t>(codec),
+		options.quality,
+		options.subsampling,
+		// Progressive replies carry the same full image.
+		static_cast<uint8_t>(options.flags & ~capture_flags::progressive),
+		negotiated.has_compression(hello_compression::png_palette),
+		// Per monitor replies always hold every monitor.
+		options.has_flag(capture_flags::per_monitor) ? uint8_t(0) : options.monitor,
+	};
+}
+
+std::vector<std::byte> encode_frame(const Frame& frame, const CaptureKey& key)
+{
+	switch (static_cast<ImageCodec>(key.codec)) {
+	case ImageCodec::Jpeg: {
+		JpegOptions jpeg_options;
+
+		jpeg_options.quality          = key.quality;
+		jpeg_options.subsampling      = key.subsampling == 0 ? ChromaSubsampling::Yuv444 : ChromaSubsampling::Yuv420;
+		jpeg_options.optimize_huffman = (key.flags & capture_flags::optimize_huffman) != 0;
+
+		return encode_jpeg(frame, jpeg_options);
+	}
+
+	case ImageCodec::Png:
+	default: {
+		PngOptions png_options;
+
+		png_options.detect_palette = key.detect_palette;
+		png_options.quantize       = (key.flags & capture_flags::quantize_palette) != 0;
+
+		return encode_png(frame, png_options);
+	}
+	}
+}
+
+std::vector<std::byte> encode_preview(const Frame& frame, const Hello& negotiated, uint32_t capture_id)
+{
+	std::vector<std::byte> preview;
+	std::vector<std::byte> image;
+	auto                   small_frame = downscale(frame, preview_max_side);
+
+	if (negotiated.supports(ImageCodec::Jpeg)) {
+		JpegOptions jpeg_options;
+
+		jpeg_options.quality     = preview_quality;
+		jpeg_options.subsampling = ChromaSubsampling::Yuv420;
+
+		image = encode_jpeg(small_frame, jpeg_options);
+	}
+	else {
+		image = encode_png(small_frame);
+	}
+
+	preview.reserve(3 * sizeof(uint32_t) + image.size());
+	append<uint32_t>(preview, capture_id);
+	append<int32_t>(preview, frame.width());
+	append<int32_t>(preview, frame.height());
+	preview.insert(preview.end(), image.begin(), image.end());
+
+	return preview;
+}
+
+void capture_screen_progressive(TcpClient& tcp_client, handlers::Session& session, const CaptureKey& key)
+{
+	uint32_t capture_id = session.capture_sequence++;
+
+	std::cout << "Capturing full screen progressively...\n";
+	auto frame = std::make_shared<const Frame>(grab_frame(key.monitor));
+
+	if (!session.negotiated.fits_frame(frame->width(), frame->height()))
+		throw ErrorCode(1, "capture: frame is larger than the negotiated maximum");
+
+	tcp_client.write(MessageType::ScreenCapturePreview, encode_preview(*frame, session.negotiated, capture_id));
+
+	// Encoding on the io thread would hold the preview and every later
+	// reply back until the full image is done.
+	handlers::post_work([&tcp_client, frame, key, capture_id]() {
+		auto capture = capture_coalescer.get(key, [&frame, &key]() {
+			return EncodedCapture{
+				frame->width(),
+				frame->height(),
+				std::make_shared<const std::vector<std::byte>>(encode_frame(*frame, key)),
+			};
+		});
+
+		std::vector<std::byte> reply;
+
+		reply.reserve(sizeof(uint32_t) + capture.data->size());
+		append<uint32_t>(reply, capture_id);
+		reply.insert(reply.end(), capture.data->begin(), capture.data->end());
+
+		tcp_client.write(MessageType::ScreenCaptureFinal, std::move(reply));
+	});
+}
+
+EncodedCapture capture_monitors(const CaptureKey& key)
+{
+	auto source   = std::atomic_load(&current_frame_source);
+	auto monitors = source->monitors();
+
+	std::cout << "Capturing " << monitors.size() << " monitors...\n";
+	auto frames = source->next_monitor_frames(monitors);
+
+	// Every monitor is encoded on its own worker, so the reply takes about
+	// as long as the largest one instead of all of them in a row.
+	std::vector< std::future< std::vector<std::byte> > > images;
+
+	for (const auto& frame : frames)
+		images.push_back(handlers::submit_work([frame, key]() { return encode_frame(frame, key); }));
+
+	EncodedCapture         capture{ 0, 0, nullptr };
+	std::vector<std::byte> reply;
+
+	append_monitor_layout(reply, monitors);
+
+	for (std::size_t i = 0; i < images.size(); i++) {
+		auto image = images[i].get();
+
+		capture.width  = std::max(capture.width, frames[i].width());
+		capture.height = std::max(capture.height, frames[i].height());
+
+		append<uint32_t>(reply, static_cast<uint32_t>(image.size()));
+		reply.insert(reply.end(), image.begin(), image.end());
+	}
+
+	capture.data = std::make_shared<const std::vector<std::byte>>(std::move(reply));
+
+	return capture;
+}
+
+void handlers::capture_screen(TcpClient& tcp_client, const std::vector<std::byte>& request)
+{
+	auto  options    = parse_capture_options(request);
+	auto& session    = get_session(tcp_client);
+	auto& negotiated = session.negotiated;
+	auto  key        = get_capture_key(options, negotiated);
+
+	// No point capturing and encoding a frame the queue would reject.
+	if (tcp_client.is_congested()) {
+		std::cout << "Send queue is full, skipping screen capture...\n";
+		return;
+	}
+
+	if (options.has_flag(capture_flags::per_monitor)) {
+		auto capture = capture_coalescer.get(key, [&key]() { return capture_monitors(key); });
+
+		if (!negotiated.fits_frame(capture.width, capture.height))
+			throw ErrorCode(1, "capture: monitor is larger than the negotiated maximum");
+
+		tcp_client.write(MessageType::ScreenCaptureMonitors, capture.data);
+		return;
+	}
+
+	if (options.has_flag(capture_flags::progressive)) {
+		capture_screen_progressive(tcp_client, session, key);
+		return;
+	}
+
+	// Requests from several viewers tend to arrive together, they all get
+	// the same buffer.
+	auto capture = capture_coalescer.get(key, [&key]() {
+		std::cout << "Capturing full screen...\n";
+		auto frame = grab_frame(key.monitor);
+
+		std::cout << "Grabbing image data...\n";
+		return EncodedCapture{
+			frame.width(),
+			frame.height(),
+			std::make_shared<const std::vector<std::byte>>(encode_frame(frame, key)),
+		};
+	});
+
+	if (!negotiated.fits_frame(capture.width, capture.height))
+		throw ErrorCode(1, "capture: frame is larger than the negotiated maximum");
+
+	tcp_client.write(MessageType::ScreenCapture, capture.data);
+}
+
+void handlers::capture_screen_tiles(TcpClient& tcp_client, const std::vector<std::byte>& request)
+{
+	// Request flags.
+	const uint8_t reset_cache = 0x01;
+
+	auto& session = get_session(tcp_client);
+
+	// The server asks for a reset whenever it sees a gap in the sequence,
+	// e.g. after a reply was dropped, since its cache no longer mirrors ours.
+	if (!request.empty() && (static_cast<uint8_t>(request[0]) & reset_cache)) {
+		std::cout << "Resetting tile cache...\n";
+		session.tile_cache.clear();
+		session.tile_sequence = 0;
+	}
+
+	if (tcp_client.is_congested()) {
+		std::cout << "Send queue is full, skipping screen capture...\n";
+		return;
+	}
+
+	std::cout << "Capturing full screen tiles...\n";
+	auto frame      = std::atomic_load(&current_frame_source)->next_frame();
+	auto image_data = encode_tiles(frame, session.tile_cache, session.tile_sequence++);
+
+	tcp_client.write(MessageType::ScreenCaptureTiles, std::move(image_data));
+}
+
+void handlers::capture_screen_stream(TcpClient& tcp_client, const std::vector<std::byte>& request)
+{
+	// Request flags.
+	const uint8_t resync = 0x01;
+
+	auto& session = get_session(tcp_client);
+
+	if (!session.capture_stream)
+		session.capture_stream = std::make_unique<CaptureStreamEncoder>();
+
+	// Sent by the server when a sequence gap shows that it missed a
+	// message, e.g. one rejected by a full send queue, and can no longer
+	// decode our deltas.
+	if (!request.empty() && (static_cast<uint8_t>(request[0]) & resync)) {
+		std::cout << "Resynchronising capture stream...\n";
+		session.capture_stream->reset();
+	}
+
+	if (tcp_client.is_congested()) {
+		std::cout << "Send queue is full, skipping screen capture...\n";
+		return;
+	}
+
+	std::cout << "Capturing full screen into the stream...\n";
+	auto frame = std::atomic_load(&current_frame_source)->next_frame();
+
+	if (!session.negotiated.fits_frame(frame.width(), frame.height()))
+		throw ErrorCode(1, "capture: frame is larger than the negotiated maximum");
+
+	tcp_client.write(MessageType::ScreenCaptureStream, session.capture_stream->encode(frame));
+}
+
+void handlers::capture_video(TcpClient& tcp_client, const std::vector<std::byte>& request)
 {
-	std::cout << "Capturing full screen...\n";
-	auto screenshot = screen::capture_full_screen();
+	auto  options = parse_video_request(request);
+	auto& session = get_session(tcp_client);
+
+	if (!session.video_encoder)
+		session.video_encoder = std::make_unique<VideoEncoder>();
 
-	std::cout << "Grabbing image data...\n";
-	auto image_data = screenshot->to_png();
+	session.video_encoder->set_rate(options.frame_rate, options.bitrate * 100);
 
-	tcp_client.write(MessageType::ScreenCapture, std::move(image_data));
-}
\ No newline at end of file
+	if (options.has_flag(video_flags::keyframe)) {
+		std::cout << "Keyframe requested...\n";
+		session.video_encoder->request_keyframe();
+	}
+
+	// Skipping before the encoder sees the frame keeps the stream intact,
+	// the next packet simply covers a longer interval.
+	if (tcp_client.is_congested()) {
+		std::cout << "Send queue is full, skipping video frame...\n";
+		return;
+	}
+
+	std::cout << "Capturing full screen into the video stream...\n";
+	auto frame = std::atomic_load(&current_frame_source)->next_frame();
+
+	if (!session.negotiated.fits_frame(frame.width(), frame.height()))
+		throw ErrorCode(1, "capture: frame is larger than the negotiated maximum");
+
+	tcp_client.write(MessageType::VideoFrame, session.video_encoder->encode(frame));
+}
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <chrono>
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include "../net/messages/message_type.h"
 #include "../net/tcp_client.h"
 #include "../graphics/screen.h"
+#include "../graphics/frame_source.h"
+#include "session.h"
 #include "../winutils/errors.h"
 
 
@@ -13,9 +17,28 @@ namespace hotk::handlers {
 	using TcpClient   = hotk::net::TcpClient;
 	using MessageType = hotk::net::messages::MessageType;
 	using Win32Error  = hotk::winutils::errors::Win32Error;
+	using FrameSource = hotk::graphics::frame_source::FrameSource;
+
+	// Replaces where capture requests get their frames from. Defaults to
+	// the real screen.
+	void set_frame_source(std::shared_ptr<FrameSource>);
+
+	// Capture requests with the same options that arrive within this long
+	// of each other share one capture and encode.
+	const std::chrono::milliseconds default_capture_freshness(50);
+	void set_capture_freshness(std::chrono::steady_clock::duration);
+
+	// Starts the capability handshake, call it on every (re)connect right
+	// after reset_session and before the first read.
+	void send_hello(TcpClient&);
+	void receive_hello(TcpClient&, const std::vector<std::byte>&);
 
 	void get_machine_info(TcpClient&);
-	void capture_screen(TcpClient&);
+	void get_monitor_layout(TcpClient&);
+	void capture_screen(TcpClient&, const std::vector<std::byte>&);
+	void capture_screen_tiles(TcpClient&, const std::vector<std::byte>&);
+	void capture_screen_stream(TcpClient&, const std::vector<std::byte>&);
+	void capture_video(TcpClient&, const std::vector<std::byte>&);
 
 	void process_message(TcpClient&, const MessageType, std::vector<std::byte>&&);
 }
@@ -0,0 +1,70 @@
+#include "session.h"
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace handlers = hotk::handlers;
+
+using handlers::Hello;
+using handlers::Session;
+using handlers::TcpClient;
+
+using hotk::net::messages::HeaderFormat;
+using hotk::net::messages::ImageCodec;
+
+namespace hello_features    = hotk::net::messages::hello_features;
+namespace hello_compression = hotk::net::messages::hello_compression;
+
+namespace {
+	std::mutex sessions_mutex;
+	std::unordered_map< const TcpClient*, std::unique_ptr<Session> > sessions;
+}
+
+Hello handlers::local_hello()
+{
+	Hello hello;
+
+	hello.version                 = hotk::net::messages::protocol_version;
+	hello.header_formats          = 1 << static_cast<uint8_t>(HeaderFormat::Legacy)
+		| 1 << static_cast<uint8_t>(HeaderFormat::Compact);
+	hello.preferred_header_format = HeaderFormat::Compact;
+	hello.codecs                  = 1 << static_cast<uint8_t>(ImageCodec::Png)
+		| 1 << static_cast<uint8_t>(ImageCodec::Jpeg);
+	hello.compression             = hello_compression::png_palette | hello_compression::png_quantize
+		| hello_compression::jpeg_optimize_huffman | hello_compression::jpeg_yuv444;
+	hello.features                = hello_features::pipelining | hello_features::tile_delta
+		| hello_features::dropped_replies | hello_features::capture_stream | hello_features::monitors
+		| hello_features::video;
+
+	return hello;
+}
+
+Session::Session()
+	: negotiated(local_hello())
+	, tile_cache(tile_cache_capacity)
+	, tile_sequence(0)
+	, capture_sequence(0)
+{
+	negotiated.version                 = 0;
+	negotiated.header_formats          = 1 << static_cast<uint8_t>(HeaderFormat::Legacy);
+	negotiated.preferred_header_format = HeaderFormat::Legacy;
+}
+
+Session& handlers::get_session(const TcpClient& tcp_client)
+{
+	std::lock_guard<std::mutex> lock(sessions_mutex);
+	auto&                       session = sessions[&tcp_client];
+
+	if (!session)
+		session = std::make_unique<Session>();
+
+	return *session;
+}
+
+void handlers::reset_session(const TcpClient& tcp_client)
+{
+	std::lock_guard<std::mutex> lock(sessions_mutex);
+
+	sessions.erase(&tcp_client);
+}
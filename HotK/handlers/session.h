@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "../net/tcp_client.h"
+#include "../net/messages/hello.h"
+#include "../graphics/tile_cache.h"
+#include "../graphics/capture_stream.h"
+#include "../graphics/video_encoder.h"
+
+namespace hotk::handlers {
+	using TcpClient = hotk::net::TcpClient;
+	using TileCache = hotk::graphics::tile_cache::TileCache;
+	using Hello     = hotk::net::messages::Hello;
+
+	using CaptureStreamEncoder = hotk::graphics::capture_stream::CaptureStreamEncoder;
+	using VideoEncoder         = hotk::graphics::video_encoder::VideoEncoder;
+
+	// Tiles the server is asked to keep for ScreenCaptureTiles replies.
+	const std::size_t tile_cache_capacity = 8192;
+
+	// What this client's handlers can do, sent to the server on connect.
+	Hello local_hello();
+
+	// Handler state that lives as long as one connection to the server.
+	struct Session {
+		// Result of the Hello exchange. Until the server's Hello arrives,
+		// and with servers that never send one, it holds every local
+		// capability with the legacy header.
+		Hello                                 negotiated;
+		TileCache                             tile_cache;
+		uint32_t                              tile_sequence;
+		// Ties progressive previews to their final image.
+		uint32_t                              capture_sequence;
+		// Created by the first ScreenCaptureStream request.
+		std::unique_ptr<CaptureStreamEncoder> capture_stream;
+		// Created by the first VideoFrame request.
+		std::unique_ptr<VideoEncoder>         video_encoder;
+
+		Session();
+	};
+
+	// Returns the session of the client, creating it on first use. Only
+	// the client's own io thread should touch it.
+	Session& get_session(const TcpClient&);
+
+	// Drops everything tied to the previous connection, call it on every
+	// (re)connect.
+	void reset_session(const TcpClient&);
+}
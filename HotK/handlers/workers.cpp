@@ -0,0 +1,55 @@
+#include "workers.h"
+
+#include <boost/asio.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+namespace handlers = hotk::handlers;
+
+namespace {
+	std::mutex              pending_mutex;
+	std::condition_variable pending_done;
+	std::size_t             pending_jobs = 0;
+
+	boost::asio::thread_pool& get_pool()
+	{
+		static boost::asio::thread_pool pool(std::max(1u, std::thread::hardware_concurrency()));
+
+		return pool;
+	}
+}
+
+void handlers::post_work(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(pending_mutex);
+		pending_jobs++;
+	}
+
+	boost::asio::post(get_pool(), [job = std::move(job)]() {
+		try {
+			job();
+		}
+		catch (const std::exception& err) {
+			std::cout << "worker: unhandled exception caught: " << err.what() << "\n";
+		}
+
+		std::lock_guard<std::mutex> lock(pending_mutex);
+
+		if (--pending_jobs == 0)
+			pending_done.notify_all();
+	});
+}
+
+void handlers::wait_for_workers()
+{
+	std::unique_lock<std::mutex> lock(pending_mutex);
+
+	pending_done.wait(lock, []() { return pending_jobs == 0; });
+}
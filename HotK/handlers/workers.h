@@ -0,0 +1,29 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace hotk::handlers {
+	// Shared pool for handler work that should not hold up a connection's
+	// io thread, one thread per core. Exceptions thrown by a job are
+	// logged and dropped.
+	void post_work(std::function<void()>);
+
+	// Like post_work, but hands the job's result or exception back through
+	// the future. Waiting on it from a worker can deadlock a busy pool.
+	template <typename Job>
+	auto submit_work(Job job) -> std::future<decltype(job())>
+	{
+		auto task   = std::make_shared< std::packaged_task<decltype(job())()> >(std::move(job));
+		auto result = task->get_future();
+
+		post_work([task]() { (*task)(); });
+
+		return result;
+	}
+
+	// Blocks until every job posted so far has finished. Call it before
+	// destroying clients that jobs may still write to.
+	void wait_for_workers();
+}
@@ -12,18 +12,33 @@
 #include "net/tcp_client.h"
 #include "net/messages/message_type.h"
 #include "handlers/handlers.h"
+#include "graphics/recording_frame_source.h"
+#include "bench/codec_bench.h"
+#include "bench/load_test.h"
 
 using hotk::errors::ErrorCode;
 using hotk::net::TcpClient;
+using hotk::net::transports::TransportOptions;
+using hotk::net::transports::TransportType;
 using hotk::net::messages::MessageType;
 using hotk::handlers::process_message;
 using hotk::graphics::screen::capture_full_screen;
+using hotk::graphics::screen::ScreenFrameSource;
+using hotk::graphics::recording_frame_source::RecordingFrameSource;
 
 using tcp = boost::asio::ip::tcp;
 using boost::system::error_code;
 
+// Upper bound for data waiting to be sent to the server.
+const std::size_t send_queue_budget = 32 * 1024 * 1024;
+
 void on_write(TcpClient&, const error_code err, const size_t length)
 {
+	if (err == boost::asio::error::no_buffer_space) {
+		std::cout << "Send queue is full, message dropped\n";
+		return;
+	}
+
 	if (err) {
 		std::cout << "Failed to send message: " << err.message() << "\n";
 		std::cout << "Bytes written: " << length << "\n";
@@ -87,27 +102,87 @@ void on_connect(TcpClient &tcp_client, const error_code err)
 	sleep_time_seconds = 30;
 	reconnect_attempt = 0;
 
+	hotk::handlers::reset_session(tcp_client);
+
 	std::cout << "Connected to server!\n";
 	std::cout << "Awaiting for server requests...\n";
 	tcp_client.clear_msg_queue();
+
+	// Only the newest screenshot is worth sending to the server, unless
+	// the handshake finds out it needs a reply for every request.
+	tcp_client.set_queue_policy(MessageType::ScreenCapture, TcpClient::QueuePolicy::LatestWins);
+	hotk::handlers::send_hello(tcp_client);
 	tcp_client.read();
 }
 
-void connect_to_server()
+void connect_to_server(const TransportOptions& transport_options)
 {
-	TcpClient tcp_client("127.0.0.1", "8080", on_connect, on_read, on_write);
+	TcpClient tcp_client(transport_options, on_connect, on_read, on_write);
+
+	tcp_client.set_queue_budget(send_queue_budget);
+
+	if (transport_options.type == TransportType::Tcp)
+		std::cout << "Connecting to server on port " << transport_options.port << "..." << std::endl;
+	else
+		std::cout << "Connecting to local server on " << transport_options.path << "..." << std::endl;
 
-	std::cout << "Connecting to server on port 8080..." << std::endl;
 	tcp_client.connect();
 	tcp_client.run();
 	tcp_client.close();
 }
 
-int main()
+int main(int argc, char* argv[])
 {
 	try {
+		if (argc > 1 && strcmp(argv[1], "--load-test") == 0) {
+			namespace load_test = hotk::bench::load_test;
+
+			auto options = load_test::parse_options(argc - 2, argv + 2);
+
+			std::cout << "Running load test with " << options.clients << " clients...\n";
+			auto report = load_test::run(options);
+			load_test::print_report(std::cout, options, report);
+			return 0;
+		}
+
+		if (argc > 1 && strcmp(argv[1], "--codec-bench") == 0) {
+			namespace codec_bench = hotk::bench::codec_bench;
+
+			auto options = codec_bench::parse_options(argc - 2, argv + 2);
+			auto report  = codec_bench::run(options);
+			codec_bench::print_report(std::cout, options, report);
+			return 0;
+		}
+
+		// --record PATH, in front of the transport options, also appends
+		// every captured frame to a corpus file for the benchmarks.
+		if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+			std::cout << "Recording captured frames to " << argv[2] << "\n";
+			hotk::handlers::set_frame_source(std::make_shared<RecordingFrameSource>(
+				std::make_shared<ScreenFrameSource>(), argv[2]));
+
+			argc -= 2;
+			argv += 2;
+		}
+
+		// Collectors running on this same host can be reached without the
+		// loopback TCP stack:
+		//   --local PATH                 unix socket or \\.\pipe\name
+		//   --shared-memory PATH NAME    same, plus the server's shared memory ring
+		TransportOptions transport_options;
+
+		if (argc > 2 && strcmp(argv[1], "--local") == 0) {
+			transport_options.type = TransportType::Local;
+			transport_options.path = argv[2];
+		}
+		else if (argc > 3 && strcmp(argv[1], "--shared-memory") == 0) {
+			transport_options.type               = TransportType::SharedMemory;
+			transport_options.path               = argv[2];
+			transport_options.shared_memory_name = argv[3];
+		}
+
 		std::cout << "Establishing connection to server..." << "\n";
-		connect_to_server();
+		connect_to_server(transport_options);
 		std::cout << "Done! Have a good day commander!\n";
 	}
 	catch (const std::exception& err) {
@@ -6,6 +6,8 @@
 namespace hotk::net::containers {
 	class BaseContainer {
 	public:
+		virtual ~BaseContainer() = default;
+
 		virtual const char* data() const noexcept = 0;
 		virtual std::size_t size() const noexcept = 0;
 	};
@@ -4,3 +4,4 @@
 #include "vector_container.h"
 #include "ptr_container.h"
 #include "primitive_container.h"
+#include "shared_container.h"
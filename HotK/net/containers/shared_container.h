@@ -0,0 +1,29 @@
+#pragma once
+
+#include <memory>
+
+#include "base_container.h"
+
+namespace hotk::net::containers {
+	// Keeps a buffer alive that other messages, possibly on other
+	// connections, send as well.
+	template<typename T>
+	class SharedContainer : public BaseContainer {
+	private:
+		std::shared_ptr<const std::vector<T>> _vec;
+
+	public:
+		SharedContainer(std::shared_ptr<const std::vector<T>> vec) noexcept
+			: _vec(std::move(vec))
+		{
+		}
+
+		const char* data() const noexcept override final {
+			return reinterpret_cast<const char*>(_vec->data());
+		}
+
+		std::size_t size() const noexcept override final {
+			return _vec->size();
+		}
+	};
+}
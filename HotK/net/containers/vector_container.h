@@ -9,8 +9,9 @@ namespace hotk::net::containers {
 	private:
 		std::vector<T> _vec;
 	public:
-		VectorContainer(const std::vector<T>&& vec) noexcept {
-			_vec = std::move(vec);
+		VectorContainer(std::vector<T>&& vec) noexcept
+			: _vec(std::move(vec))
+		{
 		}
 
 		const char* data() const noexcept override final {
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::net::messages {
+	enum class ImageCodec : uint8_t {
+		Png = 0,
+		Jpeg,
+	};
+
+	namespace capture_flags {
+		// Jpeg: optimised instead of standard Huffman tables.
+		const uint8_t optimize_huffman = 0x01;
+		// Png: also index frames that only get under 256 colours once
+		// their low bits are dropped. Lossy.
+		const uint8_t quantize_palette = 0x02;
+		// Reply with a small ScreenCapturePreview right away, followed by
+		// the full image as a ScreenCaptureFinal once it is encoded,
+		// instead of a single ScreenCapture. Both start with the capture
+		// id, in host byte order like the message header:
+		//
+		//   Preview: uint32 capture_id, int32 width, int32 height of the
+		//            full frame, then the downscaled image, Jpeg when the
+		//            handshake allowed it, else PNG
+		//   Final:   uint32 capture_id, then the image as requested
+		//
+		// The preview is the reply to the request. The final one is sent
+		// as soon as it is ready, possibly after replies to later requests.
+		const uint8_t progressive      = 0x04;
+		// Reply with a ScreenCaptureMonitors holding every monitor as its
+		// own image instead of a single ScreenCapture of the whole desktop:
+		//
+		//   the monitor layout, see MonitorLayout below
+		//   per monitor, in layout order:
+		//     uint32 size, then the image as requested
+		//
+		// Takes precedence over progressive and the monitor field.
+		const uint8_t per_monitor      = 0x08;
+	}
+
+	// Reply to a MonitorLayout request, which carries no data. Monitors
+	// are numbered from 1 in this order, x and y are relative to the top
+	// left corner of a whole desktop capture. Host byte order:
+	//
+	//   uint32 count
+	//   per monitor:
+	//     int32 x, int32 y, int32 width, int32 height
+	//     uint32 flags          monitor_flags
+	namespace monitor_flags {
+		const uint32_t primary = 0x01;
+	}
+
+	// Optional payload of a ScreenCapture request. Fields are single bytes
+	// and may be cut short, missing ones keep their default, so an empty
+	// request still gets the lossless PNG it always did:
+	//
+	//   uint8 codec          ImageCodec
+	//   uint8 quality        1-100, Jpeg only
+	//   uint8 subsampling    0 4:4:4, 1 4:2:0, Jpeg only
+	//   uint8 flags          capture_flags
+	//   uint8 monitor        0 the whole desktop, n only monitor n
+	struct CaptureOptions {
+		ImageCodec codec       = ImageCodec::Png;
+		uint8_t    quality     = 80;
+		uint8_t    subsampling = 1;
+		uint8_t    flags       = 0;
+		uint8_t    monitor     = 0;
+
+		bool has_flag(uint8_t flag) const noexcept {
+			return (flags & flag) != 0;
+		}
+	};
+
+	inline CaptureOptions parse_capture_options(const std::vector<std::byte>& data)
+	{
+		CaptureOptions options;
+		auto           field = [&data](std::size_t index, uint8_t fallback) {
+			return index < data.size() ? static_cast<uint8_t>(data[index]) : fallback;
+		};
+
+		options.codec       = static_cast<ImageCodec>(field(0, static_cast<uint8_t>(options.codec)));
+		options.quality     = field(1, options.quality);
+		options.subsampling = field(2, options.subsampling);
+		options.flags       = field(3, options.flags);
+		options.monitor     = field(4, options.monitor);
+
+		return options;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "message_type.h"
+
+namespace hotk::net::messages {
+	// How the size and type in front of every message are laid out. Every
+	// connection starts with Legacy and may switch once both ends have
+	// exchanged a Hello. Newer formats come last.
+	enum class HeaderFormat : uint8_t {
+		// uint64 size, uint16 type, both in host byte order.
+		Legacy = 0,
+		// uint32 size, uint16 type, both little endian.
+		Compact,
+	};
+
+	const std::size_t max_header_size = 10;
+
+	inline std::size_t header_size(HeaderFormat format)
+	{
+		return format == HeaderFormat::Compact ? 6 : 10;
+	}
+
+	// Compact cannot describe payloads of 4 GiB or more.
+	inline bool fits_header(HeaderFormat format, uint64_t packet_size)
+	{
+		return format != HeaderFormat::Compact || packet_size <= UINT32_MAX;
+	}
+
+	// Writes header_size(format) bytes to out.
+	inline void encode_header(HeaderFormat format, uint64_t packet_size, MessageType msg_type, std::byte* out)
+	{
+		auto type = static_cast<uint16_t>(msg_type);
+
+		if (format == HeaderFormat::Legacy) {
+			std::memcpy(out, &packet_size, sizeof(packet_size));
+			std::memcpy(out + sizeof(packet_size), &type, sizeof(type));
+			return;
+		}
+
+		for (int i = 0; i < 4; i++)
+			out[i] = static_cast<std::byte>(packet_size >> (8 * i));
+
+		out[4] = static_cast<std::byte>(type);
+		out[5] = static_cast<std::byte>(type >> 8);
+	}
+
+	// Reads header_size(format) bytes from in.
+	inline void decode_header(HeaderFormat format, const std::byte* in, uint64_t& packet_size, MessageType& msg_type)
+	{
+		uint16_t type = 0;
+
+		if (format == HeaderFormat::Legacy) {
+			std::memcpy(&packet_size, in, sizeof(packet_size));
+			std::memcpy(&type, in + sizeof(packet_size), sizeof(type));
+			msg_type = static_cast<MessageType>(type);
+			return;
+		}
+
+		packet_size = 0;
+		for (int i = 0; i < 4; i++)
+			packet_size |= static_cast<uint64_t>(in[i]) << (8 * i);
+
+		type     = static_cast<uint16_t>(static_cast<uint16_t>(in[4]) | static_cast<uint16_t>(in[5]) << 8);
+		msg_type = static_cast<MessageType>(type);
+	}
+}
@@ -0,0 +1,137 @@
+#include "hello.h"
+
+#include <algorithm>
+
+namespace messages = hotk::net::messages;
+
+using messages::Hello;
+using messages::HeaderFormat;
+
+namespace {
+	class HelloWriter {
+	private:
+		std::vector<std::byte>& _output;
+
+	public:
+		HelloWriter(std::vector<std::byte>& output)
+			: _output(output)
+		{
+		}
+
+		template <typename T>
+		void put(T value)
+		{
+			for (std::size_t i = 0; i < sizeof(T); i++)
+				_output.push_back(static_cast<std::byte>(static_cast<uint64_t>(value) >> (8 * i)));
+		}
+	};
+
+	class HelloReader {
+	private:
+		const std::vector<std::byte>& _data;
+		std::size_t                   _offset;
+
+	public:
+		HelloReader(const std::vector<std::byte>& data)
+			: _data(data)
+			, _offset(0)
+		{
+		}
+
+		// Leaves value alone when the peer's Hello ends before it.
+		template <typename T>
+		void get(T& value)
+		{
+			if (_offset + sizeof(T) > _data.size()) {
+				_offset = _data.size();
+				return;
+			}
+
+			uint64_t result = 0;
+
+			for (std::size_t i = 0; i < sizeof(T); i++)
+				result |= static_cast<uint64_t>(_data[_offset + i]) << (8 * i);
+
+			value    = static_cast<T>(result);
+			_offset += sizeof(T);
+		}
+	};
+
+	uint32_t tighter_limit(uint32_t a, uint32_t b)
+	{
+		if (a == 0 || b == 0)
+			return std::max(a, b);
+
+		return std::min(a, b);
+	}
+}
+
+std::vector<std::byte> messages::serialize_hello(const Hello& hello)
+{
+	std::vector<std::byte> output;
+	HelloWriter            writer(output);
+
+	writer.put(hello.version);
+	writer.put(hello.header_formats);
+	writer.put(static_cast<uint8_t>(hello.preferred_header_format));
+	writer.put(hello.codecs);
+	writer.put(hello.compression);
+	writer.put(hello.max_frame_width);
+	writer.put(hello.max_frame_height);
+	writer.put(hello.features);
+
+	return output;
+}
+
+Hello messages::parse_hello(const std::vector<std::byte>& data)
+{
+	Hello       hello;
+	HelloReader reader(data);
+	uint8_t     preferred = static_cast<uint8_t>(hello.preferred_header_format);
+
+	reader.get(hello.version);
+	reader.get(hello.header_formats);
+	reader.get(preferred);
+	reader.get(hello.codecs);
+	reader.get(hello.compression);
+	reader.get(hello.max_frame_width);
+	reader.get(hello.max_frame_height);
+	reader.get(hello.features);
+
+	hello.preferred_header_format = static_cast<HeaderFormat>(preferred);
+
+	// Everyone speaks the legacy header, whatever the peer claims.
+	hello.header_formats |= 1 << static_cast<uint8_t>(HeaderFormat::Legacy);
+
+	return hello;
+}
+
+Hello messages::negotiate(const Hello& local, const Hello& remote)
+{
+	Hello   result;
+	uint8_t common = local.header_formats & remote.header_formats;
+
+	result.version          = std::min(local.version, remote.version);
+	result.codecs           = local.codecs & remote.codecs;
+	result.compression      = local.compression & remote.compression;
+	result.features         = local.features & remote.features;
+	result.max_frame_width  = tighter_limit(local.max_frame_width, remote.max_frame_width);
+	result.max_frame_height = tighter_limit(local.max_frame_height, remote.max_frame_height);
+
+	if (local.preferred_header_format == remote.preferred_header_format && local.supports(local.preferred_header_format)
+			&& remote.supports(local.preferred_header_format)) {
+		result.preferred_header_format = local.preferred_header_format;
+	}
+	else {
+		result.preferred_header_format = HeaderFormat::Legacy;
+
+		for (uint8_t format = 0; format < 8; format++) {
+			if (common & (1 << format))
+				result.preferred_header_format = static_cast<HeaderFormat>(format);
+		}
+	}
+
+	result.header_formats = static_cast<uint8_t>(1 << static_cast<uint8_t>(result.preferred_header_format));
+
+	return result;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "capture_options.h"
+#include "header_format.h"
+
+namespace hotk::net::messages {
+	// Version of the Hello layout below, bump it when fields are added.
+	const uint16_t protocol_version = 1;
+
+	namespace hello_features {
+		// Requests may be sent before the previous reply arrived, replies
+		// come back in request order.
+		const uint32_t pipelining      = 0x01;
+		// ScreenCaptureTiles, frames as tiles against a shared cache.
+		const uint32_t tile_delta      = 0x02;
+		// A screenshot waiting in the send queue may be replaced by a newer
+		// one, so not every ScreenCapture request gets its own reply.
+		const uint32_t dropped_replies = 0x04;
+		// ScreenCaptureStream, frames compressed against the previous one.
+		const uint32_t capture_stream  = 0x08;
+		// MonitorLayout, plus the monitor field and per_monitor flag of
+		// CaptureOptions.
+		const uint32_t monitors        = 0x10;
+		// VideoFrame, live view as H.264.
+		const uint32_t video           = 0x20;
+	}
+
+	namespace hello_compression {
+		const uint32_t png_palette           = 0x01;
+		const uint32_t png_quantize          = 0x02;
+		const uint32_t jpeg_optimize_huffman = 0x04;
+		const uint32_t jpeg_yuv444           = 0x08;
+	}
+
+	// Sent by both ends right after connecting, the client first. Each
+	// side then runs negotiate() on its own and its peer's Hello, which
+	// gives both the same result. The server answers the client's Hello
+	// before sending any request, and after the two Hellos every message
+	// uses the negotiated header format.
+	//
+	// Little endian, fields after the ones a peer knows are ignored and
+	// missing ones keep their default:
+	//
+	//   uint16 version
+	//   uint8  header_formats    bit n set for HeaderFormat n
+	//   uint8  preferred_header_format
+	//   uint32 codecs            bit n set for ImageCodec n
+	//   uint32 compression       hello_compression
+	//   uint32 max_frame_width   0 for no limit
+	//   uint32 max_frame_height  0 for no limit
+	//   uint32 features          hello_features
+	//
+	// The defaults describe a peer from before the handshake existed.
+	struct Hello {
+		uint16_t     version                 = 0;
+		uint8_t      header_formats          = 1 << static_cast<uint8_t>(HeaderFormat::Legacy);
+		HeaderFormat preferred_header_format = HeaderFormat::Legacy;
+		uint32_t     codecs                  = 1 << static_cast<uint8_t>(ImageCodec::Png);
+		uint32_t     compression             = 0;
+		uint32_t     max_frame_width         = 0;
+		uint32_t     max_frame_height        = 0;
+		uint32_t     features                = 0;
+
+		bool supports(HeaderFormat format) const noexcept {
+			return (header_formats & (1 << static_cast<uint8_t>(format))) != 0;
+		}
+
+		bool supports(ImageCodec codec) const noexcept {
+			return static_cast<uint8_t>(codec) < 32 && (codecs & (1u << static_cast<uint8_t>(codec))) != 0;
+		}
+
+		bool has_compression(uint32_t option) const noexcept {
+			return (compression & option) != 0;
+		}
+
+		bool has_feature(uint32_t feature) const noexcept {
+			return (features & feature) != 0;
+		}
+
+		bool fits_frame(int32_t width, int32_t height) const noexcept {
+			return (max_frame_width == 0 || static_cast<uint32_t>(width) <= max_frame_width)
+				&& (max_frame_height == 0 || static_cast<uint32_t>(height) <= max_frame_height);
+		}
+	};
+
+	std::vector<std::byte> serialize_hello(const Hello&);
+	Hello parse_hello(const std::vector<std::byte>&);
+
+	// Best configuration both ends support: the lower version, common
+	// codecs, compression options and features, the tighter frame limits
+	// and a single header format, the one both prefer or otherwise the
+	// newest they share.
+	Hello negotiate(const Hello& local, const Hello& remote);
+}
@@ -8,5 +8,13 @@ namespace hotk::net::messages {
 		ScreenCapture,
 		MachineInfo,
 		ServerShutdown,
+		ScreenCaptureTiles,
+		Hello,
+		ScreenCapturePreview,
+		ScreenCaptureFinal,
+		ScreenCaptureStream,
+		MonitorLayout,
+		ScreenCaptureMonitors,
+		VideoFrame,
 	};
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hotk::net::messages {
+	namespace video_flags {
+		// Make the reply a keyframe, e.g. when the decoder was just created
+		// or a packet went missing.
+		const uint8_t keyframe = 0x01;
+	}
+
+	// Optional payload of a VideoFrame request. Like CaptureOptions every
+	// field is a single byte and missing or zero ones keep their default:
+	//
+	//   uint8 flags          video_flags
+	//   uint8 frame_rate     how often the server intends to ask, per second
+	//   uint8 bitrate        target in 100 kbit/s
+	//
+	// Changing the rate restarts the stream with a keyframe.
+	struct VideoRequest {
+		uint8_t flags      = 0;
+		uint8_t frame_rate = 15;
+		uint8_t bitrate    = 15;
+
+		bool has_flag(uint8_t flag) const noexcept {
+			return (flags & flag) != 0;
+		}
+	};
+
+	inline VideoRequest parse_video_request(const std::vector<std::byte>& data)
+	{
+		VideoRequest request;
+		auto         field = [&data](std::size_t index, uint8_t fallback) {
+			uint8_t value = index < data.size() ? static_cast<uint8_t>(data[index]) : 0;
+
+			return value != 0 ? value : fallback;
+		};
+
+		request.flags      = field(0, request.flags);
+		request.frame_rate = field(1, request.frame_rate);
+		request.bitrate    = field(2, request.bitrate);
+
+		return request;
+	}
+}
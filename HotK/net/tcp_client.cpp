@@ -1,5 +1,8 @@
 #include "tcp_client.h"
 
+#include <algorithm>
+#include <iterator>
+
 using namespace hotk::net;
 
 using boost::asio::buffer;
@@ -12,69 +15,95 @@ using executor_type = boost::asio::io_service::executor_type;
 using hotk::net::containers::BaseContainer;
 using hotk::net::containers::PtrContainer;
 using hotk::net::containers::VectorContainer;
-using hotk::net::containers::PrimitiveContainer;
+using hotk::net::containers::SharedContainer;
+
+using hotk::net::messages::header_size;
+using hotk::net::messages::fits_header;
+using hotk::net::messages::encode_header;
+using hotk::net::messages::decode_header;
+
+using hotk::net::transports::make_transport;
+
+namespace {
+	// A paced write that takes longer than this found the socket buffer
+	// full, so its rate is what the path actually drains.
+	const auto blocked_write_time = std::chrono::microseconds(500);
+	// Weight of a new sample in the drain rate estimate.
+	const double drain_rate_gain = 1.0 / 8;
+	// Applied to the estimate after a message went out without ever
+	// blocking, so the pacer keeps probing for more bandwidth.
+	const double probe_gain = 1.25;
+	// Beyond this pacing makes no difference, it also keeps the probing
+	// from running off to infinity on links that never push back.
+	const double max_estimated_rate = 10e9;
+}
 
 TcpClient::TcpClient(const char* server, const char* port, OnConnectCallback on_connect,
 		OnReadCallback on_read, OnWriteCallback on_write)
-	: _server(server)
-	, _port(port)
-	, _socket(_io_service)
-	, _packet_size(0)
-	, _message_type(MessageType::None)
+	: TcpClient(TransportOptions{ TransportType::Tcp, server, port }, on_connect, on_read, on_write)
+{
+}
+
+TcpClient::TcpClient(const TransportOptions& options, OnConnectCallback on_connect,
+		OnReadCallback on_read, OnWriteCallback on_write)
+	: _transport(make_transport(_io_service, options))
+	, _queued_bytes(0)
+	, _queue_budget(0)
+	, _header_format(HeaderFormat::Legacy)
 	, on_connect(on_connect)
 	, on_read(on_read)
 	, on_write(on_write)
+	, _pacing_enabled(false)
+	, _pacing_timer(_io_service)
+	, _pacing_tokens(0)
+	, _write_offset(0)
+	, _write_blocked(false)
 {
-	tcp::resolver        resolver(_io_service);
-	tcp::resolver::query query(_server, _port);
-
-	_endpoint = resolver.resolve(query);
 }
 
 void TcpClient::connect()
 {
-	boost::asio::async_connect(_socket, _endpoint,
-		[this](const error_code err, const tcp::endpoint) {
-			on_connect(*this, err);
-		}
-	);
+	_header_format = HeaderFormat::Legacy;
+
+	_transport->async_connect([this](const error_code err) {
+		on_connect(*this, err);
+	});
 }
 
 void TcpClient::read()
+{
+	// Deferred so that a handler which switches the header format before
+	// returning still gets the next header read in the new format.
+	boost::asio::post(_io_service, [this]() {
+		read_header();
+	});
+}
+
+void TcpClient::read_header()
 {
 	// Clear buffer in case we left it in an undefined state.
 	_internal_read_buffer.clear();
 
-	// Read the packet size of the message.
-	boost::asio::async_read(_socket, buffer(&_packet_size, sizeof(_packet_size)),
+	// Size and type arrive together, in a single read.
+	_transport->async_read(buffer(_read_header.data(), header_size(_header_format)),
 		[this](const error_code err, const size_t) {
 			if (err) {
 				on_read(*this, err, TcpClient::MessageType::None, std::move(_internal_read_buffer));
 				return;
 			}
 
-			read_msg_type(_packet_size);
-		}
-	);
-}
+			uint64_t    packet_size = 0;
+			MessageType msg_type    = MessageType::None;
 
-void TcpClient::read_msg_type(uint64_t packet_size)
-{
-	// Read the message type.
-	boost::asio::async_read(_socket, buffer(&_message_type, sizeof(_message_type)),
-		[this, packet_size](const error_code err, const size_t) {
-			if (err) {
-				on_read(*this, err, TcpClient::MessageType::None, std::move(_internal_read_buffer));
-				return;
-			}
+			decode_header(_header_format, _read_header.data(), packet_size, msg_type);
 
 			// If request does not have any data.
 			if (packet_size == 0) {
-				on_read(*this, err, _message_type, std::move(_internal_read_buffer));
+				on_read(*this, err, msg_type, std::move(_internal_read_buffer));
 				return;
 			}
 
-			read_data(packet_size, _message_type);
+			read_data(packet_size, msg_type);
 		}
 	);
 }
@@ -84,7 +113,7 @@ void TcpClient::read_data(uint64_t packet_size, MessageType msg_type)
 	_internal_read_buffer.resize(packet_size);
 
 	// Read the actual data from the server.
-	boost::asio::async_read(_socket, buffer(_internal_read_buffer),
+	_transport->async_read(buffer(_internal_read_buffer),
 		[this, msg_type](const error_code err, const size_t) {
 			on_read(*this, err, msg_type, std::move(_internal_read_buffer));
 		}
@@ -93,73 +122,294 @@ void TcpClient::read_data(uint64_t packet_size, MessageType msg_type)
 
 bool TcpClient::is_connected() const
 {
-	return _socket.is_open();
+	return _transport->is_open();
 }
 
-void TcpClient::write(TcpClient::MessageType msg_type, const char* data, std::size_t size)
+void TcpClient::set_header_format(TcpClient::HeaderFormat format)
 {
-	boost::asio::post(_io_service, [this, msg_type, data, size]() mutable {
-		bool queue_empty = _msg_queue.empty();
+	_header_format = format;
+}
 
-		// Send first the size of the packet as a uint64_t.
-		auto header_container = new PrimitiveContainer<uint64_t>(size);
-		_msg_queue.push_back(std::unique_ptr<BaseContainer>(header_container));
+TcpClient::HeaderFormat TcpClient::header_format() const
+{
+	return _header_format;
+}
 
-		auto msg_type_container = new PrimitiveContainer<uint16_t>((uint16_t)msg_type);
-		_msg_queue.push_back(std::unique_ptr<BaseContainer>(msg_type_container));
+void TcpClient::write(TcpClient::MessageType msg_type, const char* data, std::size_t size)
+{
+	boost::asio::post(_io_service, [this, msg_type, data, size]() {
+		enqueue(msg_type, std::make_unique<PtrContainer>(data, size));
+	});
+}
 
-		auto data_container = new PtrContainer(data, size);
-		_msg_queue.push_back(std::unique_ptr<BaseContainer>(data_container));
+void TcpClient::write(TcpClient::MessageType msg_type, TcpClient::ByteVector&& data)
+{
+	boost::asio::post(_io_service, [this, msg_type, data = std::move(data)]() mutable {
+		enqueue(msg_type, std::make_unique<VectorContainer<std::byte>>(std::move(data)));
+	});
+}
 
-		if (queue_empty)
-			perform_write();
+void TcpClient::write(TcpClient::MessageType msg_type, std::shared_ptr<const TcpClient::ByteVector> data)
+{
+	boost::asio::post(_io_service, [this, msg_type, data = std::move(data)]() mutable {
+		enqueue(msg_type, std::make_unique<SharedContainer<std::byte>>(std::move(data)));
 	});
 }
 
-void TcpClient::write(TcpClient::MessageType msg_type, TcpClient::ByteVector&& data)
+void TcpClient::enqueue(TcpClient::MessageType msg_type, std::unique_ptr<BaseContainer> data)
 {
-	boost::asio::post(_io_service, [this, msg_type, data]() {
-		bool queue_empty = _msg_queue.empty();
+	bool queue_empty = _msg_queue.empty();
 
-		// Send first the size of the packet as a uint64_t.
-		auto header_container = new PrimitiveContainer<uint64_t>(data.size());
-		_msg_queue.push_back(std::unique_ptr<BaseContainer>(header_container));
+	if (!fits_header(_header_format, data->size())) {
+		on_write(*this, boost::asio::error::message_size, 0);
+		return;
+	}
 
-		auto msg_type_container = new PrimitiveContainer<uint16_t>((uint16_t)msg_type);
-		_msg_queue.push_back(std::unique_ptr<BaseContainer>(msg_type_container));
+	// Send first the size of the packet followed by the type.
+	QueuedMessage message{ msg_type, HeaderBuffer(), header_size(_header_format), std::move(data) };
 
-		auto data_container = new VectorContainer<std::byte>(std::move(data));
-		_msg_queue.push_back(std::unique_ptr<BaseContainer>(data_container));
+	encode_header(_header_format, message.data->size(), msg_type, message.header.data());
 
-		if (queue_empty)
-			perform_write();
-	});
+	std::size_t message_size = message.size();
+	std::size_t budget       = _queue_budget;
+
+	// The front message might already be on the wire, so only the ones
+	// behind it can be replaced.
+	if (!queue_empty && _latest_wins_types.count(msg_type) > 0) {
+		auto queued = std::find_if(std::next(_msg_queue.begin()), _msg_queue.end(),
+			[msg_type](const QueuedMessage& queued_message) {
+				return queued_message.type == msg_type;
+			});
+
+		if (queued != _msg_queue.end()) {
+			std::size_t remaining = _queued_bytes - queued->size();
+
+			if (budget != 0 && remaining + message_size > budget) {
+				on_write(*this, boost::asio::error::no_buffer_space, 0);
+				return;
+			}
+
+			_queued_bytes = remaining + message_size;
+			*queued       = std::move(message);
+			return;
+		}
+	}
+
+	if (!queue_empty && budget != 0 && _queued_bytes + message_size > budget) {
+		on_write(*this, boost::asio::error::no_buffer_space, 0);
+		return;
+	}
+
+	_queued_bytes += message_size;
+	_msg_queue.push_back(std::move(message));
+
+	if (queue_empty)
+		perform_write();
 }
 
 void TcpClient::perform_write()
 {
 	auto& next_message = _msg_queue.front();
-	const char* data   = next_message.get()->data();
-	std::size_t size   = next_message.get()->size();
 
-	boost::asio::async_write(_socket, buffer(data, size),
+	if (_pacing_enabled) {
+		if (next_message.size() > _pacing.bulk_threshold) {
+			perform_paced_write();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(_pacing_stats_mutex);
+		_pacing_stats.exempt_messages++;
+	}
+
+	hotk::net::transports::ConstBuffers buffers = {
+		buffer(next_message.header.data(), next_message.header_size),
+		buffer(next_message.data->data(), next_message.data->size()),
+	};
+
+	// Header and data go out in a single gathered write.
+	_transport->async_write(std::move(buffers),
 		[this](error_code err, std::size_t length) {
 			if (err) {
 				on_write(*this, err, length);
 				return;
 			}
 
-			// Remove current message from queue.
-			_msg_queue.pop_front();
+			finish_write(length);
+		}
+	);
+}
 
-			if (!_msg_queue.empty())
-				perform_write();
+void TcpClient::perform_paced_write()
+{
+	auto&       message   = _msg_queue.front();
+	auto        now       = clock::now();
+	double      rate      = pacing_rate();
+	std::size_t remaining = message.size() - _write_offset;
+	std::size_t chunk     = std::min(remaining, _pacing.burst);
+
+	if (rate > 0) {
+		double elapsed = std::chrono::duration<double>(now - _pacing_refilled_at).count();
+
+		_pacing_tokens      = std::min(static_cast<double>(_pacing.burst), _pacing_tokens + elapsed * rate);
+		_pacing_refilled_at = now;
+
+		// Not enough for the next chunk yet, wait until there is.
+		if (_pacing_tokens < chunk) {
+			auto wait = std::chrono::duration_cast<std::chrono::microseconds>(
+				std::chrono::duration<double>((chunk - _pacing_tokens) / rate)) + std::chrono::microseconds(1);
+
+			{
+				std::lock_guard<std::mutex> lock(_pacing_stats_mutex);
+				_pacing_stats.waits++;
+				_pacing_stats.wait_us += wait.count();
+			}
 
-			on_write(*this, err, length);
+			_pacing_timer.expires_after(wait);
+			_pacing_timer.async_wait([this](const error_code err) {
+				if (!err)
+					perform_paced_write();
+			});
+			return;
+		}
+
+		_pacing_tokens -= chunk;
+	}
+
+	// The chunk may start in the header and run into the data.
+	hotk::net::transports::ConstBuffers buffers;
+	std::size_t                         offset = _write_offset;
+
+	if (offset < message.header_size) {
+		std::size_t size = std::min(message.header_size - offset, chunk);
+
+		buffers.push_back(buffer(message.header.data() + offset, size));
+		offset += size;
+	}
+
+	std::size_t data_offset = offset - message.header_size;
+	std::size_t data_size   = _write_offset + chunk - offset;
+
+	if (data_size > 0)
+		buffers.push_back(buffer(message.data->data() + data_offset, data_size));
+
+	_transport->async_write(std::move(buffers),
+		[this, chunk, started_at = now](error_code err, std::size_t length) {
+			if (err) {
+				on_write(*this, err, length);
+				return;
+			}
+
+			sample_drain_rate(chunk, clock::now() - started_at);
+			_write_offset += chunk;
+
+			if (_write_offset < _msg_queue.front().size()) {
+				perform_paced_write();
+				return;
+			}
+
+			std::size_t size = _write_offset;
+
+			{
+				std::lock_guard<std::mutex> lock(_pacing_stats_mutex);
+				_pacing_stats.paced_messages++;
+				_pacing_stats.paced_bytes += size;
+
+				if (_pacing.rate == 0 && !_write_blocked)
+					_pacing_stats.estimated_rate = std::min(_pacing_stats.estimated_rate * probe_gain, max_estimated_rate);
+			}
+
+			_write_offset  = 0;
+			_write_blocked = false;
+
+			finish_write(size);
 		}
 	);
 }
 
+void TcpClient::finish_write(std::size_t length)
+{
+	// Remove current message from queue.
+	_queued_bytes -= _msg_queue.front().size();
+	_msg_queue.pop_front();
+
+	if (!_msg_queue.empty())
+		perform_write();
+
+	on_write(*this, error_code(), length);
+}
+
+double TcpClient::pacing_rate() const
+{
+	if (_pacing.rate != 0)
+		return static_cast<double>(_pacing.rate);
+
+	std::lock_guard<std::mutex> lock(_pacing_stats_mutex);
+	return _pacing_stats.estimated_rate;
+}
+
+void TcpClient::sample_drain_rate(std::size_t bytes, clock::duration elapsed)
+{
+	std::lock_guard<std::mutex> lock(_pacing_stats_mutex);
+	auto&                       stats = _pacing_stats;
+
+	if (elapsed >= blocked_write_time) {
+		double sample = bytes / std::chrono::duration<double>(elapsed).count();
+
+		stats.estimated_rate = stats.estimated_rate == 0
+			? sample
+			: stats.estimated_rate + (sample - stats.estimated_rate) * drain_rate_gain;
+		_write_blocked       = true;
+	}
+
+	stats.rate = _pacing.rate != 0 ? static_cast<double>(_pacing.rate) : stats.estimated_rate;
+}
+
+void TcpClient::set_queue_budget(std::size_t bytes)
+{
+	_queue_budget = bytes;
+}
+
+void TcpClient::set_queue_policy(TcpClient::MessageType msg_type, TcpClient::QueuePolicy policy)
+{
+	if (policy == QueuePolicy::LatestWins)
+		_latest_wins_types.insert(msg_type);
+	else
+		_latest_wins_types.erase(msg_type);
+}
+
+std::size_t TcpClient::queued_bytes() const
+{
+	return _queued_bytes;
+}
+
+bool TcpClient::is_congested() const
+{
+	std::size_t budget = _queue_budget;
+
+	return budget != 0 && _queued_bytes >= budget;
+}
+
+void TcpClient::set_pacing(const TcpClient::PacingOptions& options)
+{
+	_pacing             = options;
+	_pacing.burst       = std::max<std::size_t>(_pacing.burst, 1);
+	_pacing_enabled     = true;
+	_pacing_tokens      = static_cast<double>(_pacing.burst);
+	_pacing_refilled_at = clock::now();
+}
+
+void TcpClient::disable_pacing()
+{
+	_pacing_enabled = false;
+}
+
+TcpClient::PacingStats TcpClient::pacing_stats() const
+{
+	std::lock_guard<std::mutex> lock(_pacing_stats_mutex);
+
+	return _pacing_stats;
+}
+
 void TcpClient::run()
 {
 	auto _work_guard = make_work_guard(_io_service);
@@ -168,7 +418,7 @@ void TcpClient::run()
 
 void TcpClient::close()
 {
-	_socket.close();
+	_transport->close();
 }
 
 void TcpClient::stop()
@@ -178,5 +428,9 @@ void TcpClient::stop()
 
 void TcpClient::clear_msg_queue()
 {
+	_pacing_timer.cancel();
 	_msg_queue.clear();
+	_queued_bytes  = 0;
+	_write_offset  = 0;
+	_write_blocked = false;
 }
\ No newline at end of file
@@ -3,55 +3,162 @@
 #include <boost/asio.hpp>
 
 #include <vector>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <deque>
 #include <iostream>
+#include <mutex>
+#include <unordered_set>
 
 #include "containers/message_containers.h"
 #include "messages/message_type.h"
+#include "messages/header_format.h"
+#include "transports/transport.h"
 
 namespace hotk::net {
 	class TcpClient {
+	public:
+		// What happens to a new message whose type already has a message
+		// waiting in the queue that has not started sending yet.
+		enum class QueuePolicy {
+			// Queue it behind the others.
+			Append,
+			// Replace the waiting message, only the newest one is worth sending.
+			LatestWins,
+		};
+
+		// Spreads large messages over time instead of handing them to the
+		// socket in one go, where they would fill the path's bottleneck
+		// queue and delay every other flow sharing it.
+		struct PacingOptions {
+			// Bytes per second, 0 estimates it from how fast the socket
+			// drains. Until the first estimate writes are unpaced.
+			std::size_t rate           = 0;
+			// Largest burst, also the size of every paced write.
+			std::size_t burst          = 16 * 1024;
+			// Messages up to this size, header included, are control
+			// frames and never wait for the pacer.
+			std::size_t bulk_threshold = 16 * 1024;
+		};
+
+		struct PacingStats {
+			uint64_t paced_messages  = 0;
+			uint64_t exempt_messages = 0;
+			uint64_t paced_bytes     = 0;
+			// How often and how long paced writes waited for tokens.
+			uint64_t waits           = 0;
+			uint64_t wait_us         = 0;
+			// Bytes per second currently applied, 0 while unpaced.
+			double   rate            = 0;
+			// Drain rate estimate, used when no rate is configured.
+			double   estimated_rate  = 0;
+		};
+
 	private:
 		using tcp = boost::asio::ip::tcp;
 		using io_context = boost::asio::io_context;
 		using BaseContainer = hotk::net::containers::BaseContainer;
 		using MessageType = hotk::net::messages::MessageType;
+		using HeaderFormat = hotk::net::messages::HeaderFormat;
+		using HeaderBuffer = std::array<std::byte, hotk::net::messages::max_header_size>;
 		using ByteVector = std::vector<std::byte>;
+		using Transport = hotk::net::transports::Transport;
+		using TransportOptions = hotk::net::transports::TransportOptions;
+		using TransportType = hotk::net::transports::TransportType;
+		using clock = std::chrono::steady_clock;
+
+		struct QueuedMessage {
+			MessageType                    type;
+			// Encoded when queued, in the header format of that moment.
+			HeaderBuffer                   header;
+			std::size_t                    header_size;
+			std::unique_ptr<BaseContainer> data;
+
+			std::size_t size() const noexcept {
+				return header_size + data->size();
+			}
+		};
 
 		using OnConnectCallback = void(*)(TcpClient&, const boost::system::error_code);
 		using OnReadCallback = void(*)(TcpClient&, const boost::system::error_code, const MessageType, ByteVector&&);
 		using OnWriteCallback = void(*)(TcpClient&, const boost::system::error_code, const size_t);
 
-		const char* _server;
-		const char* _port;
 		boost::asio::io_context _io_service;
-		tcp::socket _socket;
-		tcp::resolver::results_type _endpoint;
-		std::deque< std::unique_ptr<BaseContainer> > _msg_queue;
+		std::unique_ptr<Transport> _transport;
+		std::deque<QueuedMessage> _msg_queue;
+		std::atomic<std::size_t> _queued_bytes;
+		std::atomic<std::size_t> _queue_budget;
+		std::unordered_set<MessageType> _latest_wins_types;
 
 		OnConnectCallback on_connect;
 		OnReadCallback on_read;
 		OnWriteCallback on_write;
 
-		uint64_t _packet_size;
-		MessageType _message_type;
+		HeaderFormat _header_format;
+		HeaderBuffer _read_header;
 		ByteVector _internal_read_buffer;
 
+		// Pacing state, only touched on the io thread except for the
+		// stats, which pacing_stats() copies under the mutex.
+		bool _pacing_enabled;
+		PacingOptions _pacing;
+		boost::asio::steady_timer _pacing_timer;
+		double _pacing_tokens;
+		clock::time_point _pacing_refilled_at;
+		std::size_t _write_offset;
+		bool _write_blocked;
+		mutable std::mutex _pacing_stats_mutex;
+		PacingStats _pacing_stats;
+
+		void enqueue(MessageType, std::unique_ptr<BaseContainer>);
 		void perform_write();
+		void perform_paced_write();
+		void finish_write(std::size_t);
+		double pacing_rate() const;
+		void sample_drain_rate(std::size_t, clock::duration);
 
-		void read_msg_type(uint64_t);
+		void read_header();
 		void read_data(uint64_t, MessageType);
 
 	public:
 		TcpClient(const char* server, const char* port, OnConnectCallback on_connect, OnReadCallback on_read, OnWriteCallback on_write);
+		TcpClient(const TransportOptions&, OnConnectCallback on_connect, OnReadCallback on_read, OnWriteCallback on_write);
 
 		void connect();
 		void read();
 		bool is_connected() const;
 
+		// Every connection starts out with HeaderFormat::Legacy. Switching
+		// affects messages queued and headers read from then on, so it
+		// must happen on the io thread, e.g. from on_read once the Hello
+		// exchange is over.
+		void set_header_format(HeaderFormat);
+		HeaderFormat header_format() const;
+
 		void write(MessageType, const char*, std::size_t);
 		void write(MessageType, ByteVector&&);
+		// The buffer is shared, not copied, it must not change afterwards.
+		void write(MessageType, std::shared_ptr<const ByteVector>);
+
+		// Caps the bytes waiting in the send queue, 0 means unlimited. Once
+		// the budget is exhausted new messages are rejected through
+		// on_write with boost::asio::error::no_buffer_space, unless the
+		// queue is empty so oversized messages can still go out one at a
+		// time.
+		void set_queue_budget(std::size_t bytes);
+		// Must be called before run() or from the io thread.
+		void set_queue_policy(MessageType, QueuePolicy);
+		std::size_t queued_bytes() const;
+		// True when the queue is at or above its budget. Producers should
+		// check it before doing expensive work for a new message.
+		bool is_congested() const;
+
+		// Both must be called before run() or from the io thread.
+		void set_pacing(const PacingOptions&);
+		void disable_pacing();
+		PacingStats pacing_stats() const;
 
 		void stop();
 		void run();
@@ -0,0 +1,62 @@
+#include "local_transport.h"
+
+using namespace hotk::net::transports;
+
+using boost::system::error_code;
+
+LocalTransport::LocalTransport(boost::asio::io_context& io_service, const std::string& path)
+	: _io_service(io_service)
+	, _stream(io_service)
+	, _path(path)
+{
+}
+
+void LocalTransport::async_connect(ConnectHandler handler)
+{
+#if defined(_WIN32)
+	// Opening the client end of a pipe never blocks, so connect right away
+	// and report back through the io_context like the other transports.
+	error_code err;
+	HANDLE     pipe = CreateFileA(
+		_path.c_str(),
+		GENERIC_READ | GENERIC_WRITE,
+		0,
+		NULL,
+		OPEN_EXISTING,
+		FILE_FLAG_OVERLAPPED,
+		NULL);
+
+	if (pipe == INVALID_HANDLE_VALUE)
+		err = error_code(GetLastError(), boost::asio::error::get_system_category());
+	else
+		_stream.assign(pipe, err);
+
+	boost::asio::post(_io_service, [handler = std::move(handler), err]() {
+		handler(err);
+	});
+#else
+	using endpoint = boost::asio::local::stream_protocol::endpoint;
+
+	_stream.async_connect(endpoint(_path), std::move(handler));
+#endif
+}
+
+void LocalTransport::async_read(boost::asio::mutable_buffer buffer, IoHandler handler)
+{
+	boost::asio::async_read(_stream, buffer, std::move(handler));
+}
+
+void LocalTransport::async_write(ConstBuffers buffers, IoHandler handler)
+{
+	boost::asio::async_write(_stream, std::move(buffers), std::move(handler));
+}
+
+bool LocalTransport::is_open() const
+{
+	return _stream.is_open();
+}
+
+void LocalTransport::close()
+{
+	_stream.close();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "transport.h"
+
+#include <string>
+
+namespace hotk::net::transports {
+	// Same host transport that skips the loopback TCP stack: a unix domain
+	// socket, or a named pipe on Windows.
+	class LocalTransport : public Transport {
+	private:
+#if defined(_WIN32)
+		using stream_type = boost::asio::windows::stream_handle;
+#else
+		using stream_type = boost::asio::local::stream_protocol::socket;
+#endif
+
+		boost::asio::io_context& _io_service;
+		stream_type              _stream;
+		std::string              _path;
+
+	public:
+		LocalTransport(boost::asio::io_context&, const std::string& path);
+
+		void async_connect(ConnectHandler) override;
+		void async_read(boost::asio::mutable_buffer, IoHandler) override;
+		void async_write(ConstBuffers, IoHandler) override;
+
+		bool is_open() const override;
+		void close() override;
+	};
+}
@@ -0,0 +1,118 @@
+#include "shared_memory_ring.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+using namespace hotk::net::transports;
+
+namespace interprocess = boost::interprocess;
+
+SharedMemoryRing::shared_memory SharedMemoryRing::create_shared_memory(const std::string& name, std::size_t size)
+{
+#if defined(_WIN32)
+	return shared_memory(interprocess::create_only, name.c_str(), interprocess::read_write, size);
+#else
+	interprocess::shared_memory_object::remove(name.c_str());
+
+	shared_memory memory(interprocess::create_only, name.c_str(), interprocess::read_write);
+	memory.truncate(static_cast<interprocess::offset_t>(size));
+	return memory;
+#endif
+}
+
+SharedMemoryRing::SharedMemoryRing(interprocess::create_only_t, const std::string& name, std::size_t capacity)
+	: _name(name)
+	, _owner(true)
+	, _shared_memory(create_shared_memory(name, data_offset + capacity))
+	, _region(_shared_memory, interprocess::read_write)
+	, _header(new (_region.get_address()) RingHeader{ { 0 }, { 0 }, capacity })
+	, _data(static_cast<std::byte*>(_region.get_address()) + data_offset)
+{
+}
+
+SharedMemoryRing::SharedMemoryRing(interprocess::open_only_t, const std::string& name)
+	: _name(name)
+	, _owner(false)
+	, _shared_memory(interprocess::open_only, name.c_str(), interprocess::read_write)
+	, _region(_shared_memory, interprocess::read_write)
+	, _header(static_cast<RingHeader*>(_region.get_address()))
+	, _data(static_cast<std::byte*>(_region.get_address()) + data_offset)
+{
+	if (_region.get_size() < data_offset + _header->capacity)
+		throw interprocess::interprocess_exception("shared memory ring: mapping is smaller than its capacity");
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+#if !defined(_WIN32)
+	// Windows removes the mapping with its last handle, POSIX needs to be told.
+	if (_owner)
+		interprocess::shared_memory_object::remove(_name.c_str());
+#endif
+}
+
+std::size_t SharedMemoryRing::capacity() const noexcept
+{
+	return static_cast<std::size_t>(_header->capacity);
+}
+
+bool SharedMemoryRing::try_write(const std::vector<boost::asio::const_buffer>& buffers) noexcept
+{
+	const uint64_t capacity = _header->capacity;
+	const uint64_t head     = _header->head.load(std::memory_order_relaxed);
+	const uint64_t tail     = _header->tail.load(std::memory_order_acquire);
+	std::size_t    total    = 0;
+
+	for (const auto& buffer : buffers)
+		total += buffer.size();
+
+	if (total > capacity - (head - tail))
+		return false;
+
+	uint64_t position = head;
+
+	for (const auto& buffer : buffers) {
+		const auto* source    = static_cast<const std::byte*>(buffer.data());
+		std::size_t remaining = buffer.size();
+
+		// A buffer may wrap around the end of the ring.
+		while (remaining > 0) {
+			std::size_t offset = static_cast<std::size_t>(position % capacity);
+			std::size_t chunk  = std::min<std::size_t>(remaining, capacity - offset);
+
+			std::memcpy(_data + offset, source, chunk);
+			source    += chunk;
+			remaining -= chunk;
+			position  += chunk;
+		}
+	}
+
+	_header->head.store(position, std::memory_order_release);
+	return true;
+}
+
+void SharedMemoryRing::read(void* output, std::size_t size) noexcept
+{
+	const uint64_t capacity = _header->capacity;
+	const uint64_t head     = _header->head.load(std::memory_order_acquire);
+	const uint64_t tail     = _header->tail.load(std::memory_order_relaxed);
+	auto*          target   = static_cast<std::byte*>(output);
+	uint64_t       position = tail;
+
+	assert(head - tail >= size);
+	(void)head;
+
+	while (size > 0) {
+		std::size_t offset = static_cast<std::size_t>(position % capacity);
+		std::size_t chunk  = std::min<std::size_t>(size, capacity - offset);
+
+		std::memcpy(target, _data + offset, chunk);
+		target   += chunk;
+		size     -= chunk;
+		position += chunk;
+	}
+
+	_header->tail.store(position, std::memory_order_release);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <boost/asio/buffer.hpp>
+#include <boost/interprocess/creation_tags.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#if defined(_WIN32)
+#include <boost/interprocess/windows_shared_memory.hpp>
+#else
+#include <boost/interprocess/shared_memory_object.hpp>
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hotk::net::transports {
+	// Single producer, single consumer byte ring living in named shared
+	// memory. The server creates it, the client opens it and writes large
+	// payloads into it so only a small record crosses the local channel.
+	class SharedMemoryRing {
+	private:
+#if defined(_WIN32)
+		using shared_memory = boost::interprocess::windows_shared_memory;
+#else
+		using shared_memory = boost::interprocess::shared_memory_object;
+#endif
+
+		struct RingHeader {
+			std::atomic<uint64_t> head;
+			std::atomic<uint64_t> tail;
+			uint64_t              capacity;
+		};
+
+		static_assert(std::atomic<uint64_t>::is_always_lock_free,
+			"Shared Memory Ring Error: 64 bit atomics must be lock free to be shared between processes!");
+
+		// Data starts on its own cache line so head and tail updates do not
+		// bounce the first bytes of every payload between cores.
+		static const std::size_t data_offset = 64;
+
+		std::string                        _name;
+		bool                               _owner;
+		shared_memory                      _shared_memory;
+		boost::interprocess::mapped_region _region;
+		RingHeader*                        _header;
+		std::byte*                         _data;
+
+		static shared_memory create_shared_memory(const std::string& name, std::size_t size);
+
+	public:
+		// Server side: creates the ring, removing any stale one first.
+		SharedMemoryRing(boost::interprocess::create_only_t, const std::string& name, std::size_t capacity);
+		// Client side: maps a ring created by the server.
+		SharedMemoryRing(boost::interprocess::open_only_t, const std::string& name);
+		~SharedMemoryRing();
+
+		SharedMemoryRing(const SharedMemoryRing&) = delete;
+		SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+		std::size_t capacity() const noexcept;
+
+		// Copies all the buffers into the ring. Returns false without
+		// writing anything when they do not fit in the free space.
+		bool try_write(const std::vector<boost::asio::const_buffer>&) noexcept;
+
+		// Consumer side: copies the next size bytes out of the ring and
+		// releases their space. The caller must have been told through
+		// the channel that those bytes were written.
+		void read(void* output, std::size_t size) noexcept;
+	};
+}
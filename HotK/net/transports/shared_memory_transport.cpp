@@ -0,0 +1,75 @@
+#include "shared_memory_transport.h"
+
+using namespace hotk::net::transports;
+
+using boost::system::error_code;
+
+SharedMemoryTransport::SharedMemoryTransport(boost::asio::io_context& io_service, const std::string& path,
+		const std::string& shared_memory_name, std::size_t threshold)
+	: _channel(io_service, path)
+	, _shared_memory_name(shared_memory_name)
+	, _threshold(threshold)
+	, _record_header(0)
+{
+}
+
+void SharedMemoryTransport::async_connect(ConnectHandler handler)
+{
+	// The ring belongs to the server and is recreated with every server
+	// start, so map it again on every connect.
+	try {
+		_ring = std::make_unique<SharedMemoryRing>(boost::interprocess::open_only, _shared_memory_name);
+	}
+	catch (const boost::interprocess::interprocess_exception&) {
+		_ring.reset();
+	}
+
+	_channel.async_connect([this, handler = std::move(handler)](const error_code err) {
+		if (!err && !_ring) {
+			handler(boost::asio::error::not_found);
+			return;
+		}
+
+		handler(err);
+	});
+}
+
+void SharedMemoryTransport::async_read(boost::asio::mutable_buffer buffer, IoHandler handler)
+{
+	_channel.async_read(buffer, std::move(handler));
+}
+
+void SharedMemoryTransport::async_write(ConstBuffers buffers, IoHandler handler)
+{
+	std::size_t total = boost::asio::buffer_size(buffers);
+
+	if (total >= _threshold && _ring->try_write(buffers)) {
+		_record_header = ring_record_flag | total;
+
+		_channel.async_write({ boost::asio::buffer(&_record_header, sizeof(_record_header)) },
+			[handler = std::move(handler), total](const error_code err, const std::size_t) {
+				handler(err, err ? 0 : total);
+			}
+		);
+		return;
+	}
+
+	_record_header = total;
+	buffers.insert(buffers.begin(), boost::asio::buffer(&_record_header, sizeof(_record_header)));
+
+	_channel.async_write(std::move(buffers),
+		[handler = std::move(handler)](const error_code err, const std::size_t length) {
+			handler(err, length > sizeof(uint64_t) ? length - sizeof(uint64_t) : 0);
+		}
+	);
+}
+
+bool SharedMemoryTransport::is_open() const
+{
+	return _channel.is_open();
+}
+
+void SharedMemoryTransport::close()
+{
+	_channel.close();
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "transport.h"
+#include "local_transport.h"
+#include "shared_memory_ring.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace hotk::net::transports {
+	// Local transport that moves large writes through a shared memory ring.
+	//
+	// Every write from the client becomes a record on the local channel
+	// starting with a uint64_t. When its top bit is set the remaining bits
+	// are the size of the bytes waiting in the ring, otherwise they are
+	// the size of the bytes following inline. Writes too small to be worth
+	// it, or that do not fit in the ring, go inline. Reads from the server
+	// are passed through untouched.
+	class SharedMemoryTransport : public Transport {
+	private:
+		LocalTransport                    _channel;
+		std::string                       _shared_memory_name;
+		std::size_t                       _threshold;
+		std::unique_ptr<SharedMemoryRing> _ring;
+
+		// Only one write is in flight at a time, TcpClient queues the rest.
+		uint64_t                          _record_header;
+
+	public:
+		static const uint64_t ring_record_flag = uint64_t(1) << 63;
+
+		SharedMemoryTransport(boost::asio::io_context&, const std::string& path,
+			const std::string& shared_memory_name, std::size_t threshold);
+
+		void async_connect(ConnectHandler) override;
+		void async_read(boost::asio::mutable_buffer, IoHandler) override;
+		void async_write(ConstBuffers, IoHandler) override;
+
+		bool is_open() const override;
+		void close() override;
+	};
+}
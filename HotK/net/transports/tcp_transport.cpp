@@ -0,0 +1,48 @@
+#include "tcp_transport.h"
+
+using namespace hotk::net::transports;
+
+using boost::system::error_code;
+
+TcpTransport::TcpTransport(boost::asio::io_context& io_service, const char* server, const char* port)
+	: _socket(io_service)
+{
+	tcp::resolver        resolver(io_service);
+	tcp::resolver::query query(server, port);
+
+	_endpoint = resolver.resolve(query);
+}
+
+void TcpTransport::async_connect(ConnectHandler handler)
+{
+	boost::asio::async_connect(_socket, _endpoint,
+		[handler = std::move(handler)](const error_code err, const tcp::endpoint) {
+			handler(err);
+		}
+	);
+}
+
+void TcpTransport::async_read(boost::asio::mutable_buffer buffer, IoHandler handler)
+{
+	boost::asio::async_read(_socket, buffer, std::move(handler));
+}
+
+void TcpTransport::async_write(ConstBuffers buffers, IoHandler handler)
+{
+	boost::asio::async_write(_socket, std::move(buffers), std::move(handler));
+}
+
+bool TcpTransport::is_open() const
+{
+	return _socket.is_open();
+}
+
+void TcpTransport::close()
+{
+	_socket.close();
+}
+
+boost::asio::ip::tcp::socket& TcpTransport::socket() noexcept
+{
+	return _socket;
+}
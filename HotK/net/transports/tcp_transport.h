@@ -0,0 +1,26 @@
+#pragma once
+
+#include "transport.h"
+
+namespace hotk::net::transports {
+	class TcpTransport : public Transport {
+	protected:
+		using tcp = boost::asio::ip::tcp;
+
+	private:
+		tcp::socket                 _socket;
+		tcp::resolver::results_type _endpoint;
+
+	public:
+		TcpTransport(boost::asio::io_context&, const char* server, const char* port);
+
+		void async_connect(ConnectHandler) override;
+		void async_read(boost::asio::mutable_buffer, IoHandler) override;
+		void async_write(ConstBuffers, IoHandler) override;
+
+		bool is_open() const override;
+		void close() override;
+
+		tcp::socket& socket() noexcept;
+	};
+}
@@ -0,0 +1,29 @@
+#include "transport.h"
+#include "tcp_transport.h"
+#include "local_transport.h"
+#include "shared_memory_transport.h"
+#include "zero_copy_tcp_transport.h"
+
+namespace transports = hotk::net::transports;
+
+std::unique_ptr<transports::Transport> transports::make_transport(boost::asio::io_context& io_service,
+	const TransportOptions& options)
+{
+	switch (options.type) {
+	case TransportType::Local:
+		return std::make_unique<LocalTransport>(io_service, options.path);
+
+	case TransportType::SharedMemory:
+		return std::make_unique<SharedMemoryTransport>(io_service, options.path,
+			options.shared_memory_name, options.shared_memory_threshold);
+
+	case TransportType::Tcp:
+	default:
+#if defined(__linux__)
+		if (options.zero_copy_threshold > 0)
+			return std::make_unique<ZeroCopyTcpTransport>(io_service, options.server, options.port,
+				options.zero_copy_threshold);
+#endif
+		return std::make_unique<TcpTransport>(io_service, options.server, options.port);
+	}
+}
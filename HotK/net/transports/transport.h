@@ -0,0 +1,60 @@
+#pragma once
+
+#include <boost/asio.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace hotk::net::transports {
+	using ConnectHandler = std::function<void(const boost::system::error_code)>;
+	using IoHandler = std::function<void(const boost::system::error_code, const std::size_t)>;
+	using ConstBuffers = std::vector<boost::asio::const_buffer>;
+
+	// Byte stream TcpClient runs its protocol on. Reads and writes behave
+	// like boost::asio::async_read/async_write: the handler is invoked
+	// once the whole buffer has been transferred or an error occurs.
+	class Transport {
+	public:
+		virtual ~Transport() = default;
+
+		virtual void async_connect(ConnectHandler) = 0;
+		virtual void async_read(boost::asio::mutable_buffer, IoHandler) = 0;
+		virtual void async_write(ConstBuffers, IoHandler) = 0;
+
+		virtual bool is_open() const = 0;
+		virtual void close() = 0;
+	};
+
+	enum class TransportType {
+		Tcp,
+		// Unix domain socket, or a named pipe on Windows.
+		Local,
+		// Local channel plus a shared memory ring for large writes.
+		SharedMemory,
+	};
+
+	struct TransportOptions {
+		TransportType type                    = TransportType::Tcp;
+
+		// Tcp.
+		const char*   server                  = "127.0.0.1";
+		const char*   port                    = "8080";
+
+		// Tcp on Linux: writes of at least this many bytes are sent with
+		// MSG_ZEROCOPY, 0 always copies.
+		std::size_t   zero_copy_threshold     = 64 * 1024;
+
+		// Local and SharedMemory: socket path, or \\.\pipe\name on Windows.
+		std::string   path;
+
+		// SharedMemory: ring created by the server and the smallest write
+		// that is worth moving through it.
+		std::string   shared_memory_name;
+		std::size_t   shared_memory_threshold = 64 * 1024;
+	};
+
+	std::unique_ptr<Transport> make_transport(boost::asio::io_context&, const TransportOptions&);
+}
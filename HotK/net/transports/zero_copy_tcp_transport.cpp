@@ -0,0 +1,217 @@
+#include "zero_copy_tcp_transport.h"
+
+#if defined(__linux__)
+
+#include <cerrno>
+#include <vector>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+using namespace hotk::net::transports;
+
+using boost::system::error_code;
+
+namespace {
+	error_code last_error()
+	{
+		return error_code(errno, boost::asio::error::get_system_category());
+	}
+}
+
+ZeroCopyTcpTransport::ZeroCopyTcpTransport(boost::asio::io_context& io_service, const char* server,
+		const char* port, std::size_t threshold)
+	: TcpTransport(io_service, server, port)
+	, _threshold(threshold)
+	, _zero_copy(false)
+	, _total(0)
+	, _sent(0)
+	, _issued(0)
+	, _completed(0)
+	, _copied(false)
+{
+}
+
+void ZeroCopyTcpTransport::async_connect(ConnectHandler handler)
+{
+	TcpTransport::async_connect([this, handler = std::move(handler)](const error_code err) {
+		if (!err) {
+			// Kernels older than 4.14 do not know the option, they simply
+			// keep using the copying path.
+			int enable = 1;
+
+			_zero_copy = setsockopt(socket().native_handle(), SOL_SOCKET, SO_ZEROCOPY,
+				&enable, sizeof(enable)) == 0;
+		}
+
+		handler(err);
+	});
+}
+
+void ZeroCopyTcpTransport::async_write(ConstBuffers buffers, IoHandler handler)
+{
+	std::size_t total = boost::asio::buffer_size(buffers);
+
+	if (!_zero_copy || total < _threshold) {
+		TcpTransport::async_write(std::move(buffers), std::move(handler));
+		return;
+	}
+
+	_buffers   = std::move(buffers);
+	_handler   = std::move(handler);
+	_total     = total;
+	_sent      = 0;
+	_issued    = 0;
+	_completed = 0;
+
+	send_some();
+}
+
+void ZeroCopyTcpTransport::send_some()
+{
+	while (_sent < _total) {
+		std::vector<iovec> iov;
+		std::size_t        skip = _sent;
+
+		for (const auto& buffer : _buffers) {
+			if (skip >= buffer.size()) {
+				skip -= buffer.size();
+				continue;
+			}
+
+			iov.push_back({
+				const_cast<char*>(static_cast<const char*>(buffer.data())) + skip,
+				buffer.size() - skip });
+			skip = 0;
+		}
+
+		msghdr message{};
+		message.msg_iov    = iov.data();
+		message.msg_iovlen = iov.size();
+
+		ssize_t result = sendmsg(socket().native_handle(), &message, MSG_ZEROCOPY | MSG_DONTWAIT | MSG_NOSIGNAL);
+
+		if (result >= 0) {
+			// Every successful call gets its own completion notification.
+			_sent += static_cast<std::size_t>(result);
+			_issued++;
+			continue;
+		}
+
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			socket().async_wait(tcp::socket::wait_write, [this](const error_code err) {
+				if (err) {
+					finish(err);
+					return;
+				}
+
+				send_some();
+			});
+			return;
+		}
+
+		// Out of optmem for pinned pages: wait for earlier sends to
+		// complete before trying again.
+		if (errno == ENOBUFS && _issued > _completed) {
+			socket().async_wait(tcp::socket::wait_error, [this](const error_code err) {
+				error_code drain_err;
+
+				if (!err)
+					drain_completions(drain_err);
+
+				if (err || drain_err) {
+					finish(err ? err : drain_err);
+					return;
+				}
+
+				send_some();
+			});
+			return;
+		}
+
+		finish(last_error());
+		return;
+	}
+
+	wait_for_completions();
+}
+
+void ZeroCopyTcpTransport::wait_for_completions()
+{
+	error_code err;
+
+	drain_completions(err);
+	if (err || _completed >= _issued) {
+		finish(err);
+		return;
+	}
+
+	socket().async_wait(tcp::socket::wait_error, [this](const error_code err) {
+		if (err) {
+			finish(err);
+			return;
+		}
+
+		wait_for_completions();
+	});
+}
+
+void ZeroCopyTcpTransport::drain_completions(error_code& err)
+{
+	for (;;) {
+		char   control[128];
+		msghdr message{};
+
+		message.msg_control    = control;
+		message.msg_controllen = sizeof(control);
+
+		if (recvmsg(socket().native_handle(), &message, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+			if (errno != EAGAIN && errno != EWOULDBLOCK)
+				err = last_error();
+
+			return;
+		}
+
+		for (auto* header = CMSG_FIRSTHDR(&message); header != nullptr; header = CMSG_NXTHDR(&message, header)) {
+			bool ip_error = (header->cmsg_level == SOL_IP && header->cmsg_type == IP_RECVERR)
+				|| (header->cmsg_level == SOL_IPV6 && header->cmsg_type == IPV6_RECVERR);
+
+			if (!ip_error)
+				continue;
+
+			auto* extended_err = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(header));
+			if (extended_err->ee_origin != SO_EE_ORIGIN_ZEROCOPY || extended_err->ee_errno != 0)
+				continue;
+
+			// Notifications for consecutive sends may be merged into a range.
+			_completed += extended_err->ee_data - extended_err->ee_info + 1;
+
+			if (extended_err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+				_copied = true;
+		}
+	}
+}
+
+void ZeroCopyTcpTransport::finish(const error_code& err)
+{
+	// When the kernel had to copy anyway (loopback, or a device without
+	// scatter-gather) zero copy only adds notification overhead.
+	if (_copied)
+		_zero_copy = false;
+
+	auto handler = std::move(_handler);
+	_buffers.clear();
+
+	handler(err, err ? _sent : _total);
+}
+
+#endif
@@ -0,0 +1,43 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include "tcp_transport.h"
+
+#include <cstdint>
+
+namespace hotk::net::transports {
+	// Linux TCP transport that hands large writes to the kernel with
+	// MSG_ZEROCOPY instead of copying them into the socket buffer. The
+	// write handler, and with it the release of the payload, only runs
+	// once the kernel reports through the socket error queue that it is
+	// done with every page. Writes below the threshold take the normal
+	// copying path since pinning pages costs more than copying them.
+	class ZeroCopyTcpTransport : public TcpTransport {
+	private:
+		std::size_t  _threshold;
+		bool         _zero_copy;
+
+		// State of the write in progress, TcpClient only issues one at a time.
+		ConstBuffers _buffers;
+		IoHandler    _handler;
+		std::size_t  _total;
+		std::size_t  _sent;
+		uint32_t     _issued;
+		uint32_t     _completed;
+		bool         _copied;
+
+		void send_some();
+		void wait_for_completions();
+		void drain_completions(boost::system::error_code&);
+		void finish(const boost::system::error_code&);
+
+	public:
+		ZeroCopyTcpTransport(boost::asio::io_context&, const char* server, const char* port, std::size_t threshold);
+
+		void async_connect(ConnectHandler) override;
+		void async_write(ConstBuffers, IoHandler) override;
+	};
+}
+
+#endif